@@ -0,0 +1,241 @@
+/**
+ * @name bench.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 21:20:44 leo>
+ *
+ * @brief Benchmarks of the hot paths of the libcnf library.
+ *
+ * Usage: bench_cnf [number of clauses] [output file]
+ *
+ * Each benchmark prints one JSON object per line on stdout (or in the
+ * output file) giving the number of items processed, the time taken
+ * and the resulting rate. The synthetic models have about as many
+ * clauses as the first argument, 1000000 by default.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <cstdio>
+#include <unistd.h>
+
+#include <libcnf.hpp>
+
+/** Where the results are written. */
+std::ostream * results = &std::cout;
+
+/** Prevents the compiler from optimizing the measured loops away. */
+volatile long int sink;
+
+
+// !SECTION! Utilities
+// ===================
+
+/** Returns the number of seconds elapsed since `start`. */
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+        return std::chrono::duration<double>(
+                std::chrono::steady_clock::now() - start).count();
+}
+
+
+/** Writes the result of a benchmark: `items` things (in `unit`) were
+ * processed in `seconds` seconds. */
+void report(const std::string & name,
+            double items,
+            const std::string & unit,
+            double seconds)
+{
+        (*results) << "{\"benchmark\": \"" << name << "\""
+                   << ", \"items\": " << std::setprecision(12) << items
+                   << ", \"unit\": \"" << unit << "\""
+                   << ", \"seconds\": " << std::setprecision(6) << seconds
+                   << ", \"rate\": " << std::setprecision(6)
+                   << ((seconds > 0) ? items / seconds : 0)
+                   << ", \"rate_unit\": \"" << unit << "/s\"}" << std::endl;
+}
+
+
+/** Returns a random bijective S-box on n bits. */
+std::vector<unsigned int> random_sbox(unsigned int n, std::mt19937 & rng)
+{
+        std::vector<unsigned int> table(1 << n);
+        for (unsigned int x=0; x<table.size(); x++)
+                table[x] = x;
+        std::shuffle(table.begin(), table.end(), rng);
+        return table;
+}
+
+
+/** Returns the size of the file with the given path in bytes. */
+double file_size(const std::string & path)
+{
+        std::ifstream in(path.c_str(), std::ios::binary | std::ios::ate);
+        return in.tellg();
+}
+
+
+// !SECTION! Benchmarks
+// ====================
+
+void bench_var(unsigned long int n)
+{
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {1024, 64});
+        long int total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long int k=0; k<n; k++)
+                total += v.var("x", {(unsigned int)(k & 1023), (unsigned int)(k & 63)});
+        report("VariableSet::var(name)", n, "lookups", seconds_since(start));
+
+        start = std::chrono::steady_clock::now();
+        for (unsigned long int k=0; k<n; k++)
+                total += x((unsigned int)(k & 1023), (unsigned int)(k & 63));
+        report("VariableSet::var(Subset)", n, "lookups", seconds_since(start));
+        sink = total;
+}
+
+
+void bench_add_clause(unsigned long int n)
+{
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {1 << 20});
+        cnf::Formula f(&v);
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long int k=0; k<n; k++)
+                f.add_clause(cnf::Clause{x(k & 0xfffff),
+                                         cnf::no(x((k+1) & 0xfffff)),
+                                         x((k+7) & 0xfffff)});
+        report("Formula::add_clause", n, "clauses", seconds_since(start));
+
+        cnf::Formula g(&v);
+        start = std::chrono::steady_clock::now();
+        for (unsigned long int k=0; k<n/4; k++)
+                g.add_xor(x(k & 0xfffff), x((k+1) & 0xfffff), x((k+7) & 0xfffff));
+        report("Formula::add_xor", 4*(n/4), "clauses", seconds_since(start));
+}
+
+
+void bench_sbox(unsigned long int n, std::mt19937 & rng)
+{
+        for (unsigned int bits=4; bits<=8; bits+=2)
+        {
+                std::vector<unsigned int> table = random_sbox(bits, rng);
+                auto start = std::chrono::steady_clock::now();
+                cnf::Sbox s(bits, bits, table);
+                std::stringstream name;
+                name << "Sbox template (" << bits << " bits)";
+                report(name.str(), 1, "sboxes", seconds_since(start));
+        }
+
+        cnf::Sbox s(4, 4, random_sbox(4, rng));
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {1024, 4});
+        cnf::Formula f(&v);
+        unsigned long int images = 0;
+        auto start = std::chrono::steady_clock::now();
+        while (f.size() < n)
+        {
+                unsigned int r = images & 1023;
+                s.add_clauses_image(&f, x.slice({r}).codes(),
+                                    x.slice({(r + 1) & 1023}).codes());
+                images ++;
+        }
+        double elapsed = seconds_since(start);
+        report("Sbox::add_clauses_image", images, "images", elapsed);
+        report("Sbox::add_clauses_image", f.size(), "clauses", elapsed);
+}
+
+
+void bench_dimacs(unsigned long int n, const std::string & tmp, std::mt19937 & rng)
+{
+        cnf::VariableSet v;
+        unsigned int n_vars = std::max<unsigned long int>(n / 4, 64);
+        cnf::Subset x = v.add_subset("x", {n_vars});
+        cnf::Formula f(&v);
+        std::uniform_int_distribution<unsigned int> var(0, n_vars - 1);
+        for (unsigned long int k=0; k<n; k++)
+                f.add_clause(cnf::Clause{x(var(rng)),
+                                         cnf::no(x(var(rng))),
+                                         x(var(rng))});
+
+        std::string cnf_path = tmp + ".cnf";
+        auto start = std::chrono::steady_clock::now();
+        {
+                std::ofstream out(cnf_path.c_str());
+                f.to_dimacs(&out, v.size());
+        }
+        report("Formula::to_dimacs", file_size(cnf_path) / 1e6, "MB",
+               seconds_since(start));
+
+        start = std::chrono::steady_clock::now();
+        {
+                std::ofstream out(cnf_path.c_str());
+                f.to_dimacs(&out);
+        }
+        report("Formula::to_dimacs (dense)", file_size(cnf_path) / 1e6, "MB",
+               seconds_since(start));
+        std::remove(cnf_path.c_str());
+
+        // A model as printed by a SAT-solver.
+        std::string model_path = tmp + ".out";
+        {
+                std::ofstream out(model_path.c_str());
+                out << "SAT\n";
+                for (unsigned int i=0; i<n_vars; i++)
+                        out << ((rng() & 1) ? "" : "-") << x(i)
+                            << ((i % 16 == 15) ? "\n" : " ");
+                out << "0\n";
+        }
+        start = std::chrono::steady_clock::now();
+        v.parse_dimacs_file(model_path);
+        report("VariableSet::parse_dimacs_file", file_size(model_path) / 1e6,
+               "MB", seconds_since(start));
+        std::remove(model_path.c_str());
+}
+
+
+void bench_new_code(unsigned long int n)
+{
+        // Chains of equalities x[i][0] = x[i][1] = ... built in the
+        // order making them as long as possible.
+        const unsigned int length = 1000, n_chains = 64;
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {n_chains, length});
+        for (unsigned int c=0; c<n_chains; c++)
+                for (unsigned int i=length-1; i>0; i--)
+                        v.add_var_equality(x(c, i-1), x(c, i));
+        long int total = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long int k=0; k<n; k++)
+                total += v.new_code(x((unsigned int)(k % n_chains),
+                                      (unsigned int)((k * 7919) % length)));
+        report("VariableSet::new_code (chains of 1000)", n, "lookups",
+               seconds_since(start));
+        sink = total;
+}
+
+
+int main(int argc, char *argv[])
+{
+        unsigned long int n = 1000000;
+        if (argc > 1)
+                n = std::stoul(argv[1]);
+        std::ofstream output;
+        if (argc > 2)
+        {
+                output.open(argv[2]);
+                results = &output;
+        }
+        std::stringstream tmp;
+        tmp << "/tmp/libcnf_bench_" << getpid();
+        std::mt19937 rng(2026);
+
+        bench_var(10*n);
+        bench_add_clause(n);
+        bench_sbox(n, rng);
+        bench_dimacs(n, tmp.str(), rng);
+        // Each lookup follows a chain of several hundred equalities.
+        bench_new_code(n / 100);
+        return 0;
+}
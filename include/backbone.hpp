@@ -0,0 +1,103 @@
+/**
+ * @name backbone.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 15:21:48 leo>
+ *
+ * @brief Header of the Backbone class.
+ */
+
+#ifndef _CNF_BACKBONE_H_
+#define _CNF_BACKBONE_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Finds which variables of a set (e.g. the bits of a key) are forced
+ * by a Formula, i.e. have the same value in all its models, using a
+ * single IncrementalSolver:
+ *
+ * <pre>
+ * cnf::Backbone b(&f);
+ * if (b.run(k.slice({}).codes()))
+ *     for (long int lit : b.forced_literals())
+ *         std::cout << lit << " is forced" << std::endl;
+ * </pre>
+ *
+ * + every model found removes from the candidates the variables
+ *   whose value differs from the previous ones;
+ * + the remaining candidates are checked by chunks: the solver is
+ *   asked for a model where all the candidates of a chunk take the
+ *   other value, given as assumptions;
+ * + if there is none, the failed assumptions are used: a single one
+ *   means its variable is forced, several ones are checked one by
+ *   one later.
+ *
+ * If the formula was simplified by a Preprocessor, freeze the
+ * variables checked: the eliminated ones are seen as free.
+ */
+    class Backbone
+    {
+    private:
+        /** The formula whose backbone is computed. */
+        Formula * f;
+
+        /** The solver holding the formula and the forced
+         * literals found so far. */
+        IncrementalSolver solver;
+
+        /** The number of candidates checked together. */
+        unsigned int chunk_size;
+
+        /** The codes checked by the last call to run(). */
+        std::vector<long int> codes;
+
+        /** The status of each code: 1 if it is forced to true, -1 if
+         * it is forced to false and 0 if it is free. */
+        std::vector<signed char> status;
+
+        /** The literal of each code satisfied by the first model
+         * found, i.e. the one which may be forced. */
+        std::vector<long int> literals;
+
+        /** The number of calls to the solver made by run(). */
+        unsigned long int n_calls;
+
+        /** Removes from the candidates (given by their position in
+         * `codes`) those which are not satisfied by the last
+         * model. */
+        void filter(std::vector<unsigned int> & candidates);
+
+        /** Records that the i-th literal is forced. */
+        void set_forced(unsigned int i);
+
+    public:
+        /** Builds the object computing the backbone of f. The formula
+         * must not be modified until run() returns. */
+        Backbone(Formula * _f);
+
+        /** Sets the number of candidates checked together, 16 by
+         * default. */
+        void set_chunk_size(unsigned int n);
+
+        /** Finds which variables among those with the given codes are
+         * forced. Returns false if the formula is unsatisfiable. */
+        bool run(std::vector<long int> _codes);
+
+        /** Returns the literals forced by the formula, e.g. -x if x is
+         * always false. */
+        std::vector<long int> forced_literals() const;
+
+        /** Returns the codes of the variables which are not
+         * forced. */
+        std::vector<long int> free_codes() const;
+
+        /** Returns the number of calls to the solver made by the last
+         * call to run(). */
+        unsigned long int solver_calls() const;
+    };
+
+} // end namespace
+
+#endif // _BACKBONE_H_
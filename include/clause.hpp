@@ -25,6 +25,10 @@ namespace cnf {
     private:
         /** Stores the codes of the literals in this clause. */
         std::vector<long int> literals;
+
+        /** Is true if the literals are sorted and distinct, see
+         * normalize(). */
+        bool normalized;
     public:
         /** Builds an empty clause. */
         Clause();
@@ -32,19 +36,29 @@ namespace cnf {
         /** Builds a clause containing the given literals. */
         Clause(std::initializer_list<long int> lit_codes);
 
+        /** Builds a clause containing the given literals. */
+        Clause(std::vector<long int> lit_codes);
+
         /** Returns the i-th literal of the clause. */
         const long int& operator[](const unsigned int i) const;
 
         /** If the given (possibly negated) variable is in the clause,
          * returns its index within the clause. Otherwise, returns
          * -1. */
-        int variable_index(long int x);
+        int variable_index(long int x) const;
 
         /** Returns the number of literals in the clause. */
-        unsigned int size();
+        unsigned int size() const;
 
         /** Adds a new literal to the clause. */
         void push_back(long int x);
+
+        /** Sorts the literals using literal_order() and removes the
+         * duplicated ones. Returns false if the clause is a
+         * tautology, i.e. if it contains a literal and its
+         * negation. Once normalized, variable_index() uses a binary
+         * search. */
+        bool normalize();
     };
 
 } // end namespace
@@ -0,0 +1,179 @@
+/**
+ * @name compression.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 22:41:07 leo>
+ *
+ * @brief Header of the Compression class.
+ */
+
+#ifndef _CNF_COMPRESSION_H_
+#define _CNF_COMPRESSION_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Reads and writes DIMACS files compressed with gzip, xz or zstd, as
+ * most SAT-solvers read them directly.
+ *
+ * The codec used to write a file is given by the extension of its
+ * path (".gz", ".xz", ".zst"), the one used to read a file by its
+ * first bytes, so that Formula::to_dimacs_file(),
+ * VariableSet::parse_dimacs_file() and DimacsReader::read_file()
+ * handle compressed files without anything else to do:
+ *
+ * <pre>
+ * f.to_dimacs_file("model.cnf.gz");
+ * </pre>
+ *
+ * Compressed files are read through Input, which decompresses them
+ * by blocks, so that reading them does not need more memory than
+ * reading the uncompressed ones.
+ *
+ * Which codecs are available depends on the libraries found when
+ * libcnf was built (see available()). The compression is done by
+ * several threads: gzip files are written as a sequence of members
+ * compressed in parallel (which any gzip reader accepts) and xz and
+ * zstd use the multithreaded encoders of their libraries. The fast
+ * presets of each codec are used since these files are usually
+ * written once and read once.
+ */
+    class Compression
+    {
+    public:
+        /** The supported codecs. */
+        enum Codec {NONE, GZIP, XZ, ZSTD};
+
+        /** Returns true if libcnf was built with the library
+         * implementing the given codec. NONE is always available. */
+        static bool available(Codec codec);
+
+        /** Returns the codec corresponding to the extension of the
+         * given path, NONE if it is not ".gz", ".xz" or ".zst". */
+        static Codec of_path(const std::string & path);
+
+        /** Returns the codec the data between `begin` and `end` was
+         * compressed with according to its first bytes, NONE if it
+         * does not look compressed. */
+        static Codec of_content(const char * begin, const char * end);
+
+        /** Returns the extension of the files compressed with the
+         * given codec, e.g. ".gz", or an empty string for NONE. */
+        static std::string extension(Codec codec);
+
+        /** Returns the decompression of the data between `begin` and
+         * `end`, whose codec is given by of_content(). Concatenated
+         * streams (e.g. gzip members) are all decompressed. Input
+         * should be preferred for large data since the result is
+         * kept in memory as a whole.
+         *
+         * @throw std::runtime_error if the data is corrupted or the
+         * codec is not available. */
+        static std::vector<char> decompress(const char * begin,
+                                            const char * end);
+
+        /**
+         * An input stream returning the decompression of some data,
+         * which is decoded as it is read so that only a block of it
+         * is in memory at a time. The codec is given by the first
+         * bytes of the data (see of_content()); data which does not
+         * look compressed is returned as it is.
+         *
+         * DIMACS files are parsed line by line, so read_lines() gives
+         * the decompressed text by blocks of whole lines:
+         *
+         * <pre>
+         * cnf::Compression::Input in(begin, end);
+         * const char * lines_begin, * lines_end;
+         * while (in.read_lines(lines_begin, lines_end, 1 << 22))
+         *     parse(lines_begin, lines_end);
+         * </pre>
+         *
+         * The errors of the codec (corrupted or truncated data) are
+         * thrown as std::runtime_error by the reading methods.
+         */
+        class Input : public std::istream
+        {
+        private:
+            /** Reads the compressed data and decompresses it. */
+            std::unique_ptr<std::streambuf> decoder;
+
+            /** The buffer of read_lines(): the lines it returned
+             * last are before `lines_cut`, the beginning of the next
+             * ones between `lines_cut` and `lines_filled`. */
+            std::vector<char> lines;
+            std::size_t lines_cut, lines_filled;
+
+        public:
+            /** Decompresses the data between `begin` and `end`,
+             * which must stay available while the stream is read.
+             *
+             * @throw std::runtime_error if the codec is not
+             * available. */
+            Input(const char * begin, const char * end);
+
+            /** Decompresses the data read from `input` as it is
+             * needed.
+             *
+             * @throw std::runtime_error if the codec is not
+             * available. */
+            Input(std::istream * input);
+
+            ~Input();
+
+            /** Makes `begin` and `end` delimit the next lines of the
+             * decompressed data: about `block_size` bytes ending
+             * with a line break, except the last ones. A line longer
+             * than `block_size` is returned whole. The text stays
+             * available until the next call. Returns false once all
+             * the data was returned.
+             *
+             * @throw std::runtime_error if the data is corrupted. */
+            bool read_lines(const char * & begin,
+                            const char * & end,
+                            std::size_t block_size);
+        };
+
+        /**
+         * An output stream writing in a file what is written in it,
+         * compressed with the given codec.
+         *
+         * <pre>
+         * cnf::Compression::Output out("model.cnf.xz", cnf::Compression::XZ);
+         * f.to_dimacs(&out);
+         * out.close();
+         * </pre>
+         */
+        class Output : public std::ostream
+        {
+        private:
+            /** Compresses the content of the stream and writes it in
+             * the file. */
+            std::unique_ptr<std::streambuf> encoder;
+
+        public:
+            /** Opens the file with the given path (which is
+             * truncated) and uses `n_threads` threads to compress
+             * it, as many as there are cores if it is 0.
+             *
+             * @throw std::runtime_error if the file cannot be opened
+             * or the codec is not available. */
+            Output(const std::string & path,
+                   Codec codec,
+                   unsigned int n_threads = 0);
+
+            /** Calls close() if it was not called, ignoring the
+             * errors. */
+            ~Output();
+
+            /** Compresses what remains and closes the file.
+             *
+             * @throw std::runtime_error if it cannot be written. */
+            void close();
+        };
+    };
+
+} // end namespace
+
+#endif // _COMPRESSION_H_
@@ -0,0 +1,108 @@
+/**
+ * @name cubeandconquer.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 16:05:31 leo>
+ *
+ * @brief Header of the CubeAndConquer class.
+ */
+
+#ifndef _CNF_CUBEANDCONQUER_H_
+#define _CNF_CUBEANDCONQUER_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Solves a Formula in parallel by splitting it into cubes: if d
+ * variables are chosen, each of the 2^d assignments of these
+ * variables is a cube, and the formula is satisfiable if and only if
+ * it is under the assumptions given by one of the cubes.
+ *
+ * <pre>
+ * cnf::CubeAndConquer c(&f);
+ * c.set_threads(64);
+ * c.set_split_variables(k.slice({0}).codes()); // e.g. 8 key bits
+ * if (c.run())
+ *     key = v.extract(k);
+ * </pre>
+ *
+ * If no variables are given, they are chosen by lookahead: the
+ * variables assigning the most literals by unit propagation when set
+ * either way are used.
+ *
+ * Each thread owns an IncrementalSolver and solves the cubes of its
+ * queue one after another, keeping what it learns from one cube to
+ * the next. A thread whose queue is empty steals half of the cubes
+ * of another one, so that easy cubes do not leave threads idle. All
+ * threads stop as soon as a model is found.
+ */
+    class CubeAndConquer
+    {
+    private:
+        /** The cubes [first, second) left to a thread, identified by
+         * their index. */
+        struct WorkQueue
+        {
+            std::mutex lock;
+            std::deque<std::pair<unsigned long int, unsigned long int> > ranges;
+        };
+
+        /** The formula to solve. */
+        Formula * f;
+
+        /** The number of threads used. */
+        unsigned int n_threads;
+
+        /** The codes of the variables to split on. */
+        std::vector<long int> split_codes;
+
+        /** The number of variables chosen by lookahead, 0 to choose it
+         * from the number of threads. */
+        unsigned int lookahead_depth;
+
+        /** Statistics of the last call to run(). */
+        unsigned long int n_cubes, n_solved_cubes, n_steals;
+
+        /** Returns the variables chosen by lookahead. */
+        std::vector<long int> lookahead_variables();
+
+        /** Takes the next cube of the queue. Returns false if it is
+         * empty. */
+        static bool pop(WorkQueue & q, unsigned long int & cube);
+
+        /** Moves half of the first range of the victim to the
+         * thief. Returns false if there is nothing to steal. */
+        static bool steal(WorkQueue & victim, WorkQueue & thief);
+
+    public:
+        /** Builds the solver of the formula f, using as many threads
+         * as there are cores. */
+        CubeAndConquer(Formula * _f);
+
+        /** Sets the number of threads used. */
+        void set_threads(unsigned int n);
+
+        /** Sets the variables to split on. */
+        void set_split_variables(std::vector<long int> codes);
+
+        /** Sets the number of variables to split on when they are
+         * chosen by lookahead. */
+        void set_lookahead_depth(unsigned int depth);
+
+        /** Returns true if the formula is satisfiable, in which case
+         * the VariableSet is assigned according to the model
+         * found.
+         *
+         * @throw std::domain_error if there are more than 40 variables
+         * to split on. */
+        bool run();
+
+        /** Prints on stdout the number of cubes, of cubes solved and
+         * of steals of the last call to run(). */
+        void print_statistics() const;
+    };
+
+} // end namespace
+
+#endif // _CUBEANDCONQUER_H_
@@ -0,0 +1,98 @@
+/**
+ * @name decomposition.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 16:48:10 leo>
+ *
+ * @brief Header of the Decomposition class.
+ */
+
+#ifndef _CNF_DECOMPOSITION_H_
+#define _CNF_DECOMPOSITION_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Splits a Formula into its connected components, i.e. sets of
+ * clauses sharing no variable with the others, e.g. the clauses of
+ * several independent S-box queries stored in the same formula. They
+ * are found using a union-find structure on the variables (after
+ * renaming by VariableSet::new_code()).
+ *
+ * Each component is a Formula of its own whose variables are
+ * numbered from 1 in a VariableSet of its own; component_codes()
+ * gives the code in the original VariableSet of each of them.
+ *
+ * <pre>
+ * cnf::Decomposition d(&f);
+ * std::cout << d.size() << " components" << std::endl;
+ * if (d.solve())
+ *     y = v.extract(y_subset);
+ * </pre>
+ *
+ * solve() solves the components in parallel with one
+ * IncrementalSolver each and assigns the original VariableSet
+ * according to the union of their models.
+ */
+    class Decomposition
+    {
+    private:
+        /** A connected component of the formula. */
+        struct Component
+        {
+            /** The set in which its variables live. */
+            VariableSet variables;
+
+            /** Its clauses, using the codes of `variables`. */
+            Formula formula;
+
+            /** codes[i] is the code of the variable i+1 in the
+             * original VariableSet. */
+            std::vector<long int> codes;
+
+            Component() : formula(&variables) {}
+        };
+
+        /** The formula decomposed. */
+        Formula * f;
+
+        /** Its connected components. */
+        std::vector<std::unique_ptr<Component> > components;
+
+        /** Is true if the formula contains the empty clause, which
+         * is in no component. */
+        bool has_empty_clause;
+
+        /** The number of threads used by solve(). */
+        unsigned int n_threads;
+
+    public:
+        /** Finds the connected components of f. The formula must not
+         * be modified while the decomposition is used. */
+        Decomposition(Formula * _f);
+
+        /** Returns the number of components. */
+        unsigned int size() const;
+
+        /** Returns the i-th component. */
+        const Formula & component(unsigned int i) const;
+
+        /** Returns the codes in the original VariableSet of the
+         * variables 1, 2... of the i-th component. */
+        const std::vector<long int> & component_codes(unsigned int i) const;
+
+        /** Sets the number of threads used by solve(), the number of
+         * cores by default. */
+        void set_threads(unsigned int n);
+
+        /** Solves the components in parallel. Returns true if all of
+         * them are satisfiable, in which case the original
+         * VariableSet is assigned accordingly; the variables which
+         * appear in no clause are set to false. */
+        bool solve();
+    };
+
+} // end namespace
+
+#endif // _DECOMPOSITION_H_
@@ -0,0 +1,130 @@
+/**
+ * @name dimacsreader.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 22:03:16 leo>
+ *
+ * @brief Header of the DimacsReader class.
+ */
+
+#ifndef _CNF_DIMACSREADER_H_
+#define _CNF_DIMACSREADER_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Loads a CNF formula in DIMACS format into a Formula, e.g. an
+ * instance generated by another tool.
+ *
+ * <pre>
+ * cnf::VariableSet v;
+ * cnf::Formula f(&v);
+ * cnf::DimacsReader r;
+ * r.read_file("instance.cnf", &f);
+ * </pre>
+ *
+ * The variable i of the file is the variable with code i in the
+ * VariableSet of the formula. If the set does not have enough
+ * variables, a subset called "dimacs" is added to it so that it
+ * does.
+ *
+ * Comments ("c" lines) and the header ("p cnf" line) are skipped and
+ * so is everything after a "%" line. Clauses may span several lines.
+ * XOR constraints are accepted as written by CryptoMiniSat: the line
+ * "x1 -2 3 0" means that the xor of these literals is true. They are
+ * turned into clauses, the long ones being cut into pieces of at
+ * most MAX_XOR_SIZE literals chained with new variables which are put
+ * in a subset called "dimacs_xor". An XOR constraint must fit on one
+ * line.
+ *
+ * Files compressed with gzip, xz or zstd are decompressed by blocks
+ * of a few dozen megabytes (see Compression::Input), each block being
+ * parsed before the next one is decompressed, so that the whole text
+ * is never in memory. Streams are read in the same way.
+ *
+ * read_file() maps the file in memory and cuts it, or each block of
+ * it, into as many chunks as there are threads, at line boundaries;
+ * each chunk is parsed by a thread and the literals are then copied
+ * in parallel into the arena of the formula.
+ */
+    class DimacsReader
+    {
+    public:
+        /** The length of the longest XOR constraint turned directly
+         * into clauses (there are 2^(MAX_XOR_SIZE-1) of them). */
+        static const unsigned int MAX_XOR_SIZE = 5;
+
+    private:
+        /** The number of threads used. */
+        unsigned int n_threads;
+
+        /** Statistics on the last formula read. */
+        unsigned long int n_clauses, n_xors, n_variables;
+
+        /** What is carried from a block of text to the next one. */
+        struct Progress;
+
+        /** Parses the text between `begin` and `end`, which ends at
+         * the end of a line, and adds the clauses it contains to the
+         * formula f. */
+        void read_block(const char * begin,
+                        const char * end,
+                        Formula * f,
+                        Progress & progress);
+
+        /** Adds to f the clause lacking its 0 at the end of the text,
+         * if any, the variables it needs and its XOR constraints. */
+        void finish(Formula * f, Progress & progress);
+
+        /** Parses the text between `begin` and `end` and adds what it
+         * contains to the formula f. `path` is used in the error
+         * messages. */
+        void read(const char * begin,
+                  const char * end,
+                  Formula * f,
+                  const std::string & path);
+
+        /** Same as above but parses the text given by `input` one
+         * block after the other. */
+        void read_input(Compression::Input * input,
+                        Formula * f,
+                        const std::string & path);
+
+    public:
+        /** Creates a reader using as many threads as there are
+         * cores. */
+        DimacsReader();
+
+        /** Sets the number of threads used to parse a file. */
+        void set_threads(unsigned int n);
+
+        /** Adds the clauses and XOR constraints of the DIMACS file
+         * with the given path to the formula f.
+         *
+         * @throw std::runtime_error if the file cannot be read or is
+         * not valid. If it is compressed, the clauses found before the
+         * error are left in f. */
+        void read_file(const std::string & path, Formula * f);
+
+        /** Same as above but reads the formula from a stream, which
+         * is always read by blocks. */
+        void read_stream(std::istream * input, Formula * f);
+
+        /** Returns the number of clauses read by the last call,
+         * without those encoding XOR constraints. */
+        unsigned long int clauses_read() const;
+
+        /** Returns the number of XOR constraints read by the last
+         * call. */
+        unsigned long int xors_read() const;
+
+        /** Returns the largest variable of the last formula read, or
+         * the number of variables given by its header if it is
+         * larger. */
+        unsigned long int variables_read() const;
+    };
+
+} // end namespace
+
+#endif // _DIMACSREADER_H_
@@ -0,0 +1,95 @@
+/**
+ * @name enumerator.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 14:40:12 leo>
+ *
+ * @brief Header of the Enumerator class.
+ */
+
+#ifndef _CNF_ENUMERATOR_H_
+#define _CNF_ENUMERATOR_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Enumerates the solutions of a Formula using an IncrementalSolver:
+ * each time a model is found, it is given to a callback and a
+ * blocking clause forbidding it is added to the solver.
+ *
+ * The solutions are projected onto a set of variables, e.g. a
+ * subset of the VariableSet: two models which only differ on the
+ * other variables are the same solution. By default, all the
+ * variables are used.
+ *
+ * <pre>
+ * cnf::Enumerator e(&f);
+ * e.set_projection(k.slice({}).codes());
+ * e.set_limit(1000);
+ * e.run([&](cnf::VariableSet * v) {
+ *     keys.push_back(v->extract(k));
+ *     return true; // false stops the enumeration
+ * });
+ * </pre>
+ *
+ * In the minimal blocking mode, the projection variables are
+ * decided first and the blocking clause only contains the negation
+ * of the decisions made on them, the other projection variables
+ * being implied by these decisions. It is usually much shorter than
+ * the whole projected model.
+ *
+ * If the formula was simplified by a Preprocessor, freeze the
+ * projection variables: the others are assigned by
+ * Formula::extend_model() before the callback is called.
+ */
+    class Enumerator
+    {
+    private:
+        /** The formula whose solutions are enumerated. */
+        Formula * f;
+
+        /** The solver holding the formula and the blocking
+         * clauses. */
+        IncrementalSolver solver;
+
+        /** The codes of the variables the solutions are projected
+         * onto. */
+        std::vector<long int> projection;
+
+        /** The maximum number of solutions, 0 if there is none. */
+        unsigned long int limit;
+
+        /** Is true if the blocking clauses only contain the
+         * decisions. */
+        bool minimal_blocking;
+
+    public:
+        /** Builds an enumerator of the solutions of f. The formula
+         * must not be modified until the enumeration is over. */
+        Enumerator(Formula * _f);
+
+        /** Sets the variables the solutions are projected onto. */
+        void set_projection(std::vector<long int> codes);
+
+        /** Stops the enumeration after `n` solutions; 0 removes the
+         * limit. */
+        void set_limit(unsigned long int n);
+
+        /** Enables or disables the minimal blocking clauses. */
+        void set_minimal_blocking(bool enable);
+
+        /** Finds the solutions not found by the previous calls and
+         * gives each of them to the callback through the
+         * VariableSet, which is assigned accordingly. The enumeration
+         * stops when the callback returns false. Returns the number
+         * of solutions found. */
+        unsigned long int run(std::function<bool(VariableSet *)> callback);
+
+        /** Returns the solver used, e.g. to print its statistics. */
+        IncrementalSolver & incremental_solver();
+    };
+
+} // end namespace
+
+#endif // _ENUMERATOR_H_
@@ -13,29 +13,280 @@
 
 namespace cnf {
 
+/** Counts what the normalization of the clauses added to a Formula
+ * has saved (see Formula::set_normalization()). */
+    struct NormalizationCounters
+    {
+        /** The number of literals removed because they appeared
+         * several times in the same clause. */
+        unsigned long int duplicate_literals;
+
+        /** The number of clauses dropped because they were
+         * tautologies. */
+        unsigned long int tautologies;
+
+        /** The number of clauses dropped because they were already
+         * in the formula. */
+        unsigned long int duplicate_clauses;
+    };
+
 /** Models a CNF formula, i.e. the conjunction of an arbitrary number
  * of disjunctive clauses.
  *
- * Clauses are represented using instances of the Clause class. */
+ * Clauses are given using instances of the Clause class but they are
+ * stored one after the other in a unique array of 32-bit literals
+ * (see Lit), the "arena", the position of the first literal of each
+ * clause being stored in another array.
+ *
+ * Clauses can also be stored outside of the arena in read-only
+ * segments, e.g. the memory mapped clauses of a Snapshot. They come
+ * first, the clauses of the arena being numbered after them.
+ *
+ * freeze() turns the arena into such a segment. The segments are
+ * shared, not copied, when a formula is copied, so that many variants
+ * of a large formula only store the clauses they add to it:
+ *
+ * <pre>
+ * base.freeze();
+ * cnf::Formula f1 = base.variant(), f2 = base.variant();
+ * f1.add_clause(...); // base and f2 are unchanged
+ * </pre>
+ *
+ * If normalization is enabled with set_normalization(), the clauses
+ * are normalized when they are added (see Clause::normalize()):
+ * tautologies are dropped and so are the clauses already in the
+ * formula. To find those quickly, the clauses of the arena are
+ * indexed by their hash.
+ *
+ * A formula too large to be kept in memory can be written in a DIMACS
+ * file as it is built, see stream_to(). */
     class Formula
     {
     private:
         /** The set in which the variables used for this formula live. */
         VariableSet * v;
         
-        /** Stores the clauses corresponding to this CNF. */
-        std::vector<Clause> clauses;
+        /** Stores the literals of all the clauses of this CNF, one
+         * clause after the other. */
+        std::vector<Lit> literals;
+
+        /** clause_starts[i] is the position in `literals` of the
+         * first literal of the i-th clause. Its last element is the
+         * size of `literals`. */
+        std::vector<unsigned long int> clause_starts;
+
+        /** A read-only block of clauses living outside the arena. */
+        struct ClauseSegment
+        {
+            /** The literals of the clauses, one clause after the
+             * other. */
+            const Lit * literals;
+
+            /** starts[i] is the position in `literals` of the first
+             * literal of the i-th clause of the segment; there are
+             * n_clauses+1 of them. */
+            const unsigned long int * starts;
+
+            /** The number of clauses in the segment. */
+            unsigned long int n_clauses;
+
+            /** The index in the formula of the first clause of the
+             * segment. */
+            unsigned long int first_clause;
+
+            /** Keeps the memory holding the segment alive. */
+            std::shared_ptr<const void> owner;
+        };
+
+        /** The read-only segments, whose clauses come before those of
+         * the arena. */
+        std::vector<ClauseSegment> segments;
+
+        /** The total number of clauses in the segments. */
+        unsigned long int n_segment_clauses;
+
+        /** Is true if the clauses are normalized when added. */
+        bool normalizing;
+
+        /** Maps the hash of each normalized clause to its index. */
+        std::unordered_multimap<std::size_t, unsigned long int> clause_index;
+
+        /** Counts what was saved by the normalization. */
+        NormalizationCounters counters;
+
+        /** Stores the clauses removed by the Preprocessor which are
+         * needed to extend a model of the simplified formula to the
+         * variables it eliminated. The first literal of each clause
+         * is the one to set to true if the clause is not satisfied;
+         * the stack is read from its end. */
+        std::vector<Clause> reconstruction_stack;
+
+        friend class Preprocessor;
+        friend class Snapshot;
+        friend class FormulaTemplate;
+        friend class FormulaBuilder;
+        friend class DimacsReader;
+
+        /** Is true if add_var_equality() only records the equalities
+         * in `deferred_equalities` instead of giving them to the
+         * VariableSet, which is the case for the shards of a
+         * FormulaBuilder. */
+        bool deferring_equalities;
+
+        /** The pairs of codes given to add_var_equality() while
+         * `deferring_equalities` is true, one after the other. */
+        std::vector<long int> deferred_equalities;
+
+        /** Describes the file written by the last call to
+         * to_dimacs_file(). */
+        struct DimacsExport
+        {
+            /** The path of the file, empty if there is none. */
+            std::string path;
+
+            /** The number of clauses written in it. */
+            unsigned long int n_clauses;
+
+            /** The number of equalities of the VariableSet when it
+             * was written. */
+            unsigned long int n_equalities;
+
+            /** The size, modification time and inode of the file
+             * after it was written, used to check that nobody else
+             * wrote it since. */
+            unsigned long int file_size, mtime, inode;
+
+            /** A hash of the literals written in the file, which is
+             * also written in its first line so that a file of the
+             * same size written by someone else is not taken for
+             * it. */
+            uint64_t fingerprint;
+
+            /** The number of clauses which were already in the file
+             * and were not written again. */
+            unsigned long int reused;
+
+            /** The code of each variable of the file: the variable
+             * i has code codes[i-1]. */
+            std::vector<long int> codes;
+
+            /** dense[x] is the number of the variable with code x in
+             * the file, 0 if it does not appear in it. */
+            std::vector<long int> dense;
+        };
+
+        /** The last file written by to_dimacs_file(). */
+        DimacsExport last_export;
+
+        /** Writes the clauses of a streaming formula in its sink. */
+        struct ClauseStream;
+
+        /** The sink of the clauses if the formula is streaming (see
+         * stream_to()), NULL otherwise. It is shared by the copies
+         * of the formula. */
+        std::shared_ptr<ClauseStream> stream;
+
+        /** Returns a hash of the clause with the given index. */
+        std::size_t clause_hash(unsigned long int i) const;
+
+        /** Returns true if the clauses with the given indices contain
+         * the same literals in the same order. */
+        bool same_clauses(unsigned long int i, unsigned long int j) const;
+
+        /** Removes all the clauses of the formula and returns its
+         * previous arena (literals and clause starts). The segments
+         * are dropped. */
+        void clear(std::vector<Lit> & old_literals,
+                   std::vector<unsigned long int> & old_starts);
+
+        /** Writes the clauses of the formula with the given stream,
+         * removes them and makes it the sink of the next ones. */
+        void start_stream(std::shared_ptr<ClauseStream> s);
+
+        /** Writes the given clause in the stream. */
+        void write_to_stream(const Clause & c);
+
+        /** Returns the segment containing the i-th clause, which
+         * must be in a segment. */
+        const ClauseSegment & segment_of(unsigned long int i) const;
+
+        /** Appends a read-only segment of `n_clauses` clauses stored
+         * as described in ClauseSegment. The arena must be empty.
+         *
+         * @throw std::logic_error if the arena is not empty. */
+        void add_segment(const Lit * lits,
+                         const unsigned long int * starts,
+                         unsigned long int n_clauses,
+                         std::shared_ptr<const void> owner);
     public:
         /** Creates an empty formula and initializes the v attribute. */
         Formula(VariableSet * _v);
 
-        /** Adds the given clause at the end of the CNF formula. */
+        /** Enables or disables the normalization of the clauses when
+         * they are added. If it is enabled, the clauses already in
+         * the formula are normalized as well. */
+        void set_normalization(bool enable);
+
+        /** Returns the number of literals, tautologies and clauses
+         * removed by the normalization so far. */
+        NormalizationCounters normalization_counters() const;
+
+        /** Adds the given clause at the end of the CNF formula. If
+         * normalization is enabled, the clause is normalized first
+         * and it is not added if it is a tautology or if it is
+         * already in the formula. */
         void add_clause(Clause new_clause);
 
+        /** Moves the clauses of the arena into a new read-only
+         * segment, which is then shared by the copies of the
+         * formula. The clauses keep their indices and new clauses
+         * can still be added. */
+        void freeze();
+
+        /** Returns a copy of the formula. It shares the segments of
+         * this formula and only copies its arena, which is empty
+         * after freeze(), and its normalization index if any. */
+        Formula variant() const;
+
+        /** Returns the number of clauses stored in the read-only
+         * segments, i.e. which are shared with other formulas or
+         * memory mapped. */
+        unsigned long int n_frozen_clauses() const;
+
+        /** Returns the number of clauses stored in the formula, i.e.
+         * without those written by a stream (see stream_to()). */
+        unsigned long int size() const;
+
+        /** Returns an estimate of the memory used by the formula in
+         * bytes: the arena, the normalization index and the
+         * reconstruction stack (without the literals of its
+         * clauses). The segments are not counted since they are
+         * shared or memory mapped. */
+        unsigned long int memory_usage() const;
+
+        /** Returns the set in which the variables of the formula
+         * live. */
+        VariableSet * variables() const;
+
+        /** Returns a copy of the i-th clause of the formula. */
+        Clause clause(unsigned long int i) const;
+
+        /** Returns a pointer to the first literal of the i-th
+         * clause, whose code is given by Lit::code(). */
+        const Lit * clause_begin(unsigned long int i) const;
+
+        /** Returns a pointer just after the last literal of the i-th
+         * clause. */
+        const Lit * clause_end(unsigned long int i) const;
+
         /** Adds the given clauses at the end of the CNF formula. */
         void add_clauses(std::initializer_list<Clause> new_clauses);
 
-        /** Enforces the use of a unique code for both variables, i.e. calls  */
+        /** Enforces the use of a unique code for both variables, i.e.
+         * calls VariableSet::add_var_equality(). If the formula is
+         * streaming, the clauses of add_var_equality_clauses() are
+         * written instead since those already in the sink cannot be
+         * renamed. */
         void add_var_equality(long int v1, long int v2);
 
         /** Adds clauses enforcing the the literals with the given
@@ -102,6 +353,112 @@ namespace cnf {
          * and glucose don't).*/
         void to_dimacs(std::ostream * out,
                        unsigned int card_variables);
+
+        /** Prints on the given output stream a DIMACS formatted
+         * representation of this CNF formula where only the variables
+         * actually used are declared. They are renumbered from 1 in
+         * the order of their first occurrence so that the SAT-solver
+         * does not allocate anything for the variables renamed
+         * through VariableSet::add_var_equality() or never used.
+         *
+         * Returns the correspondance, which must be given to
+         * VariableSet::parse_dimacs() to read the assignment of the
+         * variables correctly. */
+        DimacsNumbering to_dimacs(std::ostream * out);
+
+        /** Writes the formula in the file with the given path like
+         * to_dimacs(std::ostream*) does, except that the numbers of
+         * the header are padded to a fixed width.
+         *
+         * If the file was written by the previous call to this method
+         * on this formula and if the only changes since then are new
+         * clauses, only these are appended to it and the header is
+         * rewritten in place, so that solving a formula again after
+         * adding a few clauses does not cost a full export. Otherwise
+         * (other path, clauses removed, new equalities in the
+         * VariableSet, file modified by someone else), the whole
+         * file is written. To tell them apart, an uncompressed file
+         * starts with a comment line giving a fingerprint of its
+         * clauses, which must match the one of the last export.
+         *
+         * If the path ends with ".gz", ".xz" or ".zst", the file is
+         * compressed accordingly (see Compression) and always written
+         * as a whole.
+         *
+         * Returns the numbering of the variables in the file (see
+         * to_dimacs(std::ostream*)).
+         *
+         * @throw std::runtime_error if the file cannot be written. */
+        DimacsNumbering to_dimacs_file(const std::string & path);
+
+        /** Returns the number of clauses written in the file by the
+         * last call to to_dimacs_file() which were not written again,
+         * i.e. 0 if the whole file was written. */
+        unsigned long int last_export_reused() const;
+
+        /** Makes the formula write the clauses it is given in the
+         * DIMACS file with the given path instead of storing them, so
+         * that the memory needed to build a formula does not depend
+         * on its size:
+         *
+         * <pre>
+         * f.stream_to("model.cnf");
+         * ... // add_clause(), add_xor(), Sbox::add_clauses_image()...
+         * f.end_stream();
+         * </pre>
+         *
+         * The clauses already in the formula are written first and
+         * removed from it. The clauses are written through a buffer
+         * of fixed size, their literals being renamed with
+         * VariableSet::new_code() at that time, so the equalities
+         * given to the VariableSet must come before the clauses using
+         * them; add_var_equality() writes two clauses instead.
+         * Duplicate clauses are not removed even if normalization is
+         * enabled. The header is written with the numbers of
+         * variables and clauses known at the end, the number of
+         * variables being the largest one written if the VariableSet
+         * is smaller.
+         *
+         * If the path ends with ".gz", ".xz" or ".zst", the clauses
+         * are written in a temporary file next to it, compressed at
+         * the end (see Compression).
+         *
+         * @throw std::logic_error if the formula is already
+         * streaming.
+         *
+         * @throw std::runtime_error if the file cannot be written. */
+        void stream_to(const std::string & path);
+
+        /** Same as above but the clauses are written in the given
+         * stream (e.g. a pipe to a SAT-solver), without header. */
+        void stream_to(std::ostream * out);
+
+        /** Writes what remains in the buffer, the header and closes
+         * the file. The formula then stores its clauses again.
+         * Returns the number of clauses written.
+         *
+         * @throw std::logic_error if the formula is not streaming.
+         *
+         * @throw std::runtime_error if the file cannot be written. */
+        unsigned long int end_stream();
+
+        /** Returns true if stream_to() was called and end_stream()
+         * was not. */
+        bool is_streaming() const;
+
+        /** Returns the number of clauses written in the sink so far;
+         * they are not counted by size(). */
+        unsigned long int n_streamed_clauses() const;
+
+        /** Assigns the variables removed from this formula by a
+         * Preprocessor so that the assignment of the VariableSet,
+         * which must satisfy the simplified formula, satisfies the
+         * original one as well. Does nothing if the formula was not
+         * preprocessed.
+         *
+         * @throw std::logic_error if the variables have not been
+         * assigned yet. */
+        void extend_model();
     };
 
 } // end namespace
@@ -0,0 +1,105 @@
+/**
+ * @name formulabuilder.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 20:15:37 leo>
+ *
+ * @brief Header of the FormulaBuilder class.
+ */
+
+#ifndef _CNF_FORMULABUILDER_H_
+#define _CNF_FORMULABUILDER_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Builds a Formula with several threads. Each thread adds its clauses
+ * to a "shard", a Formula of its own, so that Sbox::add_clauses_image(),
+ * Formula::add_xor(), FormulaTemplate::instantiate() and the like can
+ * be used on it without locking anything. The shards are then merged
+ * into the target formula, their arenas being copied in parallel.
+ *
+ * <pre>
+ * cnf::FormulaBuilder b(&f);
+ * cnf::Subset x = b.add_subset("x", {R+1, 16});
+ * b.run(R, [&](cnf::Formula * shard, unsigned long int r) {
+ *         for (unsigned int i=0; i<4; i++)
+ *             sbox.add_clauses_image(shard, ...);
+ *     });
+ * // f now contains the clauses of the R rounds.
+ * </pre>
+ *
+ * The VariableSet must not be modified directly while the shards are
+ * being built: the subsets are added with add_subset(), which can be
+ * called from any thread, and the equalities given to
+ * Formula::add_var_equality() on a shard are recorded and given to
+ * the VariableSet by merge(). The codes must be computed with the
+ * Subset handles rather than with VariableSet::var().
+ *
+ * The shards are merged in the order in which they were created. If
+ * the builder is deterministic (the default), run() creates one shard
+ * per task so that the clauses are in the order of the tasks whatever
+ * the scheduling; otherwise each thread has a single shard in which
+ * it adds the clauses of all the tasks it picks, which uses less
+ * memory but makes the order of the clauses vary from one run to
+ * another.
+ */
+    class FormulaBuilder
+    {
+    private:
+        /** The formula being built. */
+        Formula * f;
+
+        /** The shards not merged yet. */
+        std::vector<std::unique_ptr<Formula> > shards;
+
+        /** Protects `shards` and the VariableSet. */
+        std::mutex lock;
+
+        /** The number of threads used by run() and merge(). */
+        unsigned int n_threads;
+
+        /** Is true if run() creates one shard per task. */
+        bool deterministic;
+
+    public:
+        /** Creates a builder adding its clauses to f. */
+        FormulaBuilder(Formula * _f);
+
+        /** Sets the number of threads used by run() and merge(); the
+         * default is the number of cores. */
+        void set_threads(unsigned int n);
+
+        /** Chooses whether run() puts the clauses of the tasks in
+         * their order or in an order depending on the scheduling. */
+        void set_deterministic(bool enable);
+
+        /** Calls VariableSet::add_subset() on the VariableSet of the
+         * formula. Can be called from several threads at once. */
+        Subset add_subset(const std::string & name,
+                          std::initializer_list<unsigned int> dim);
+
+        /** Returns a new empty shard. Can be called from several
+         * threads at once; the shard must then only be used by one
+         * thread. */
+        Formula * new_shard();
+
+        /** Returns the number of shards not merged yet. */
+        unsigned int n_shards();
+
+        /** Calls task(shard, i) for i in [0, n_tasks) using several
+         * threads, then calls merge(). */
+        void run(unsigned long int n_tasks,
+                 std::function<void(Formula *, unsigned long int)> task);
+
+        /** Appends the clauses of all the shards to the formula in
+         * the order in which the shards were created, gives their
+         * equalities to the VariableSet and deletes them. No thread
+         * may be using a shard at this point. */
+        void merge();
+    };
+
+} // end namespace
+
+#endif // _FORMULABUILDER_H_
@@ -0,0 +1,95 @@
+/**
+ * @name formulatemplate.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 19:41:12 leo>
+ *
+ * @brief Header of the FormulaTemplate class.
+ */
+
+#ifndef _CNF_FORMULATEMPLATE_H_
+#define _CNF_FORMULATEMPLATE_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * The clauses of a formula captured once and then copied many times
+ * with other variables, e.g. the round function of a cipher.
+ *
+ * The variables of the captured formula must belong to "slots", which
+ * are ranges of consecutive codes such as those returned by
+ * Subset::slice(). Instantiating the template binds each slot to
+ * another range of the same size: the clauses are appended to a
+ * formula after shifting each literal by the difference between the
+ * first codes of its slot and of the range it is bound to. This is a
+ * copy of the literals plus an addition, much faster than calling
+ * Sbox::add_clauses_image(), Formula::add_xor() and the like again.
+ *
+ * <pre>
+ * cnf::Subset x = v.add_subset("x", {R+1, 64}), k = v.add_subset("k", {R, 64});
+ * cnf::Formula round(&v);
+ * ... // the clauses linking x[0], k[0] and x[1]
+ * cnf::FormulaTemplate t(round, {x.slice({0}), k.slice({0}), x.slice({1})});
+ * for (unsigned int r=0; r<R; r++)
+ *     t.instantiate(&f, {x.slice({r}), k.slice({r}), x.slice({r+1})});
+ * </pre>
+ *
+ * The equalities of the VariableSet are not part of the template:
+ * those added with Formula::add_var_equality() while building it must
+ * be added again for each instance.
+ */
+    class FormulaTemplate
+    {
+    private:
+        /** The ranges of codes the template was captured with. */
+        std::vector<CodeRange> slots;
+
+        /** The literals of the clauses, one clause after the other,
+         * as in the arena of a Formula. */
+        std::vector<Lit> literals;
+
+        /** clause_starts[i] is the position in `literals` of the first
+         * literal of the i-th clause. Its last element is the size of
+         * `literals`. */
+        std::vector<unsigned long int> clause_starts;
+
+        /** literal_slots[k] is the index of the slot containing the
+         * variable of literals[k]. */
+        std::vector<unsigned int> literal_slots;
+
+    public:
+        /** Captures the clauses of the formula f, whose variables
+         * must belong to the given slots. If several slots contain
+         * a variable, the first one is used.
+         *
+         * @throw std::domain_error if a variable is in no slot. */
+        FormulaTemplate(const Formula & f, std::vector<CodeRange> _slots);
+
+        /** Calls the constructor above with the
+         * std::initializer_list turned into a vector. */
+        FormulaTemplate(const Formula & f,
+                        std::initializer_list<CodeRange> _slots);
+
+        /** Returns the number of clauses of the template. */
+        unsigned long int size() const;
+
+        /** Returns the number of slots of the template. */
+        unsigned int n_slots() const;
+
+        /** Appends the clauses of the template to the formula f, the
+         * i-th slot being replaced by the i-th range of `bindings`.
+         *
+         * @throw std::domain_error if there are not as many bindings
+         * as slots or if a binding is not as large as its slot. */
+        void instantiate(Formula * f, std::vector<CodeRange> bindings) const;
+
+        /** Calls instantiate() with the std::initializer_list turned
+         * into a vector. */
+        void instantiate(Formula * f,
+                         std::initializer_list<CodeRange> bindings) const;
+    };
+
+} // end namespace
+
+#endif // _FORMULATEMPLATE_H_
@@ -0,0 +1,334 @@
+/**
+ * @name incrementalsolver.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 14:02:37 leo>
+ *
+ * @brief Header of the IncrementalSolver class.
+ */
+
+#ifndef _CNF_INCREMENTALSOLVER_H_
+#define _CNF_INCREMENTALSOLVER_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * A CDCL SAT-solver running inside the program, as opposed to the
+ * Solver class which calls an external one. It is incremental:
+ * clauses can be added between two calls to solve() and everything
+ * learnt so far is kept, and a formula can be solved under
+ * assumptions, i.e. literals which are only true for one call.
+ *
+ * <pre>
+ * cnf::IncrementalSolver s(&v);
+ * s.add_formula(f);
+ * if (s.solve({v.var("k", {0})}))
+ *     s.store_model();
+ * else
+ *     core = s.failed_assumptions();
+ * </pre>
+ *
+ * The literals are renamed using VariableSet::new_code() when they
+ * are given to the solver, like in Formula::to_dimacs().
+ *
+ * It is a plain MiniSat-like solver: two watched literals, first UIP
+ * learning, VSIDS heuristic with phase saving, Luby restarts and
+ * reduction of the learnt clauses database.
+ */
+    class IncrementalSolver
+    {
+    private:
+        /** A clause stored in the solver. The two first literals are
+         * the watched ones. */
+        struct StoredClause
+        {
+            std::vector<unsigned int> lits;
+            bool learnt;
+            bool deleted;
+            double activity;
+        };
+
+        /** An element of a watch list: the clause and one of its
+         * literals, which is checked first. */
+        struct Watcher
+        {
+            unsigned int clause;
+            unsigned int blocker;
+        };
+
+        /** Marks the absence of reason for an assignment. */
+        static const unsigned int NO_REASON = 0xffffffff;
+
+        /** The set in which the variables live. */
+        VariableSet * v;
+
+        /** The number of variables known by the solver. */
+        unsigned int n_vars;
+
+        /** Is false if the clauses are unsatisfiable whatever the
+         * assumptions. */
+        bool ok;
+
+        /** All the clauses, learnt or not. */
+        std::vector<StoredClause> clauses;
+
+        /** The indices of the learnt clauses. */
+        std::vector<unsigned int> learnts;
+
+        /** watches[l] contains the clauses watching the literal l,
+         * which are visited when l becomes false. */
+        std::vector<std::vector<Watcher> > watches;
+
+        /** The value of each variable: 1, -1 or 0 if unassigned. */
+        std::vector<signed char> assigns;
+
+        /** The decision level at which each variable was assigned. */
+        std::vector<unsigned int> level;
+
+        /** The clause which implied each variable. */
+        std::vector<unsigned int> reason;
+
+        /** The assigned literals in chronological order. */
+        std::vector<unsigned int> trail;
+
+        /** The position in trail of the first literal of each
+         * decision level. */
+        std::vector<unsigned int> trail_lim;
+
+        /** The position in trail of the next literal to propagate. */
+        unsigned int qhead;
+
+        /** The VSIDS activity of each variable. */
+        std::vector<double> activity;
+
+        /** The amount by which activities are increased. */
+        double var_inc;
+
+        /** The amount by which clause activities are increased. */
+        double cla_inc;
+
+        /** A binary heap of variables ordered by activity. */
+        std::vector<unsigned int> heap;
+
+        /** The position of each variable in the heap, -1 if it is not
+         * in it. */
+        std::vector<int> heap_index;
+
+        /** The saved phase of each variable: true if its last value
+         * was false. */
+        std::vector<bool> polarity;
+
+        /** Variables decided before all the others, in this order. */
+        std::vector<unsigned int> priority;
+
+        /** Used by the conflict analysis. */
+        std::vector<bool> seen;
+
+        /** The assumptions of the current call to solve(). */
+        std::vector<unsigned int> assumptions;
+
+        /** The codes of these assumptions, as given to solve(). */
+        std::vector<long int> assumption_codes;
+
+        /** The failed assumptions found by the last call. */
+        std::vector<unsigned int> conflict;
+
+        /** The model found by the last successful call. */
+        std::vector<signed char> model;
+
+        /** The decisions which led to the last model. */
+        std::vector<unsigned int> model_decisions;
+
+        /** The maximum number of learnt clauses. */
+        double max_learnts;
+
+        /** Is set to true by solve() if it was stopped before
+         * finding an answer. */
+        bool was_interrupted;
+
+        /** solve() stops as soon as this flag (if any) is true. */
+        const std::atomic<bool> * stop_flag;
+
+        /** The maximum number of conflicts of a call to solve(),
+         * negative if there is none. */
+        long int conflict_limit;
+
+        /** The number of conflicts allowed before the current call to
+         * solve() stops, negative if there is no limit. */
+        long int conflicts_left;
+
+        /** Statistics. */
+        unsigned long int n_conflicts, n_decisions, n_propagations;
+
+        /** Returns the internal literal corresponding to a code,
+         * i.e. 2x+1 for -x and 2x for x, x being the variable it is
+         * renamed into. */
+        unsigned int internal_literal(long int code);
+
+        /** Same as above for a literal of a Formula, whose index is
+         * already encoded this way. */
+        unsigned int internal_literal(Lit l);
+
+        /** Returns the code of an internal literal. */
+        static long int code(unsigned int l)
+        {
+            return (l & 1) ? (-1)*(long int)(l >> 1) : (long int)(l >> 1);
+        }
+
+        /** Returns the value of a literal: 1, -1 or 0. */
+        inline int value(unsigned int l) const
+        {
+            return (l & 1) ? -assigns[l >> 1] : assigns[l >> 1];
+        }
+
+        /** Returns the current decision level. */
+        inline unsigned int decision_level() const
+        {
+            return trail_lim.size();
+        }
+
+        /** Makes sure the variables up to x exist. */
+        void ensure_variables(unsigned int x);
+
+        /** Adds a clause made of internal literals. */
+        void add_internal_clause(std::vector<unsigned int> c);
+
+        /** Watches the two first literals of the clause. */
+        void attach(unsigned int cref);
+
+        /** Assigns the literal l because of the clause `from`. */
+        void enqueue(unsigned int l, unsigned int from);
+
+        /** Propagates the assignments; returns the index of a clause
+         * which is false or NO_REASON. */
+        unsigned int propagate();
+
+        /** Derives a learnt clause from the conflict. */
+        void analyze(unsigned int confl,
+                     std::vector<unsigned int> & learnt,
+                     unsigned int & backtrack_level);
+
+        /** Computes the assumptions responsible for p being false. */
+        void analyze_final(unsigned int p);
+
+        /** Cancels the assignments above the given level. */
+        void backtrack(unsigned int target_level);
+
+        /** Returns the next decision literal, or NO_REASON if all the
+         * variables are assigned. */
+        unsigned int pick_branch_literal();
+
+        /** Returns true if the stop flag is set or if the conflict
+         * limit is reached. */
+        bool must_stop() const;
+
+        /** Runs the search until a restart is needed; returns 1 if a
+         * model is found, -1 if the clauses are unsatisfiable and 0
+         * otherwise. */
+        int search(long int n_allowed_conflicts);
+
+        /** Removes half of the learnt clauses. */
+        void reduce_db();
+
+        void bump_variable(unsigned int x);
+        void bump_clause(unsigned int cref);
+        void heap_insert(unsigned int x);
+        void heap_up(unsigned int i);
+        void heap_down(unsigned int i);
+        unsigned int heap_pop();
+
+    public:
+        /** Builds a solver without clauses whose variables live in
+         * the given set. */
+        IncrementalSolver(VariableSet * _v);
+
+        /** Adds a clause. */
+        void add_clause(Clause c);
+
+        /** Adds all the clauses of a formula. */
+        void add_formula(const Formula & f);
+
+        /** Looks for an assignment satisfying the clauses. Returns
+         * true if one is found. */
+        bool solve();
+
+        /** Looks for an assignment satisfying the clauses where the
+         * given literals are true. Returns true if one is found;
+         * otherwise, failed_assumptions() tells which assumptions
+         * are responsible for it. */
+        bool solve(std::vector<long int> assumed);
+
+        /** Calls solve() with the std::initializer_list turned into
+         * a vector. */
+        bool solve(std::initializer_list<long int> assumed);
+
+        /** Returns true if the last call to solve() was stopped (by
+         * the stop flag or the conflict limit) before finding an
+         * answer, in which case it returned false. */
+        bool interrupted() const;
+
+        /** Makes solve() stop as soon as `*flag` is true. Give NULL to
+         * remove the flag. */
+        void set_stop_flag(const std::atomic<bool> * flag);
+
+        /** Makes solve() stop after `limit` conflicts. A negative
+         * limit removes it. */
+        void set_conflict_limit(long int limit);
+
+        /** Returns the subset of the assumptions of the last call to
+         * solve() which is enough to make the clauses
+         * unsatisfiable. It is empty if they are unsatisfiable
+         * whatever the assumptions. */
+        std::vector<long int> failed_assumptions() const;
+
+        /** Returns the value of the literal with the given code in
+         * the last model found.
+         *
+         * @throw std::logic_error if no model was found. */
+        bool model_value(long int lit);
+
+        /** Returns the decisions which led to the last model found,
+         * as codes of literals. All the other literals of the model
+         * are implied by them and the clauses. */
+        std::vector<long int> model_decision_literals() const;
+
+        /** Assigns the variables of the set given to the constructor
+         * according to the last model found, like
+         * VariableSet::parse_dimacs() would.
+         *
+         * @throw std::logic_error if no model was found. */
+        void store_model();
+
+        /** Returns the number of literals assigned by unit
+         * propagation when the literal with the given code is set
+         * to true, or -1 if it leads to a conflict. The literal is
+         * unassigned afterwards. Used to choose the variables to
+         * split on. */
+        long int probe(long int lit);
+
+        /** Makes the solver decide the variables with the given codes
+         * before all the others, in this order. */
+        void set_priority(std::vector<long int> codes);
+
+        /** Sets the value tried first when deciding the variable of
+         * the literal with the given code: this literal is made
+         * true. */
+        void set_phase(long int lit);
+
+        /** Calls set_phase() on each literal, e.g. those of a
+         * previous model given by VariableSet::assignment(), so that
+         * the search starts from it. */
+        void set_phases(std::vector<long int> lits);
+
+        /** Returns the number of variables known by the solver. */
+        unsigned int n_variables() const;
+
+        /** Prints on stdout the number of conflicts, decisions and
+         * propagations so far. */
+        void print_statistics() const;
+    };
+
+} // end namespace
+
+#endif // _INCREMENTALSOLVER_H_
@@ -11,22 +11,51 @@
 
 #include <cstdint>
 #include <ctime>
+#include <cmath>
+#include <cstring>
 
 #include <vector>
 #include <string>
 #include <map>
+#include <bitset>
 #include <initializer_list>
 #include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+#include <unordered_map>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <memory>
 
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 
+#include "literal.hpp"
 #include "variableset.hpp"
 #include "clause.hpp"
 #include "formula.hpp"
+#include "resultcache.hpp"
+#include "compression.hpp"
 #include "solver.hpp"
 #include "sbox.hpp"
+#include "preprocessor.hpp"
+#include "incrementalsolver.hpp"
+#include "enumerator.hpp"
+#include "backbone.hpp"
+#include "cubeandconquer.hpp"
+#include "decomposition.hpp"
+#include "localsearch.hpp"
+#include "snapshot.hpp"
+#include "formulatemplate.hpp"
+#include "formulabuilder.hpp"
+#include "statistics.hpp"
+#include "dimacsreader.hpp"
 
 /**
  * This library provides an easy way to build crypto-oriented CNF
@@ -51,6 +80,16 @@ namespace cnf {
     {
         return (-1) * x;
     }
+
+    /** The order used to sort the literals of a clause: by variable,
+     * the positive literal coming first. */
+    inline bool literal_order(long int a, long int b)
+    {
+        long int
+            abs_a = (a > 0) ? a : (-1)*a,
+            abs_b = (b > 0) ? b : (-1)*b;
+        return (abs_a < abs_b) || (abs_a == abs_b && a > b);
+    }
 }
 
 
@@ -0,0 +1,175 @@
+/**
+ * @name literal.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 23:20:52 leo>
+ *
+ * @brief Header of the Var and Lit classes.
+ */
+
+#ifndef _CNF_LITERAL_H_
+#define _CNF_LITERAL_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+    class Lit;
+
+/**
+ * A variable stored on 32 bits: its code in the VariableSet.
+ */
+    class Var
+    {
+    private:
+        uint32_t x;
+
+    public:
+        /** The largest code a variable can have so that its literals
+         * fit on 32 bits. */
+        static const uint32_t MAX_CODE = (1U << 31) - 1;
+
+        /** Creates the variable with code 0, which is not a
+         * variable and can be used as a placeholder. */
+        Var() : x(0) {}
+
+        /** Creates the variable with the given code. */
+        explicit Var(uint32_t code) : x(code) {}
+
+        /** Returns the code of the variable. */
+        uint32_t code() const
+        {
+            return x;
+        }
+
+        /** Returns the literal which is true when the variable is. */
+        Lit positive() const;
+
+        /** Returns the literal which is true when the variable is
+         * false. */
+        Lit negative() const;
+
+        bool operator==(Var other) const
+        {
+            return x == other.x;
+        }
+
+        bool operator!=(Var other) const
+        {
+            return x != other.x;
+        }
+
+        bool operator<(Var other) const
+        {
+            return x < other.x;
+        }
+    };
+
+
+/**
+ * A literal stored on 32 bits as 2x for the variable x and 2x+1 for
+ * its negation, like in IncrementalSolver and LocalSearch: negating a
+ * literal flips its lowest bit and its variable is obtained with a
+ * shift, so that arrays indexed by the literals (occurrence lists,
+ * watches) are easy to build.
+ *
+ * The rest of the library gives literals as the signed codes used in
+ * DIMACS files (x or no(x) = -x); they are converted with Lit(code)
+ * and code(). The literal 0 (i.e. Lit()) corresponds to the code 0,
+ * which is not a variable.
+ */
+    class Lit
+    {
+    private:
+        uint32_t x;
+
+    public:
+        /** Creates the literal with index 0, which corresponds to no
+         * variable and can be used as a placeholder. */
+        Lit() : x(0) {}
+
+        /** Creates the literal with the given signed code, i.e. x for
+         * the variable with code x and -x for its negation. */
+        explicit Lit(long int code)
+            : x((code >= 0) ? 2*(uint32_t)code : 2*(uint32_t)(-code) + 1) {}
+
+        /** Creates the literal of the variable v, negated if
+         * `negated` is true. */
+        Lit(Var v, bool negated) : x(2*v.code() + (negated ? 1 : 0)) {}
+
+        /** Returns the literal with the given index (see index()). */
+        static Lit from_index(uint32_t i)
+        {
+            Lit l;
+            l.x = i;
+            return l;
+        }
+
+        /** Returns the signed code of the literal. */
+        long int code() const
+        {
+            long int abs_code = x >> 1;
+            return (x & 1) ? (-1)*abs_code : abs_code;
+        }
+
+        /** Returns the number used to index arrays by literals: 2x
+         * or 2x+1. */
+        uint32_t index() const
+        {
+            return x;
+        }
+
+        /** Returns the variable of the literal. */
+        Var var() const
+        {
+            return Var(x >> 1);
+        }
+
+        /** Returns true if it is the negation of its variable. */
+        bool is_negated() const
+        {
+            return (x & 1) != 0;
+        }
+
+        /** Returns the negation of this literal. */
+        Lit operator~() const
+        {
+            return from_index(x ^ 1);
+        }
+
+        /** Returns this literal negated if `b` is true. */
+        Lit operator^(bool b) const
+        {
+            return from_index(x ^ (b ? 1 : 0));
+        }
+
+        bool operator==(Lit other) const
+        {
+            return x == other.x;
+        }
+
+        bool operator!=(Lit other) const
+        {
+            return x != other.x;
+        }
+
+        bool operator<(Lit other) const
+        {
+            return x < other.x;
+        }
+    };
+
+
+    inline Lit Var::positive() const
+    {
+        return Lit(*this, false);
+    }
+
+
+    inline Lit Var::negative() const
+    {
+        return Lit(*this, true);
+    }
+
+} // end namespace
+
+#endif // _LITERAL_H_
@@ -0,0 +1,155 @@
+/**
+ * @name localsearch.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 17:30:44 leo>
+ *
+ * @brief Header of the LocalSearch class.
+ */
+
+#ifndef _CNF_LOCALSEARCH_H_
+#define _CNF_LOCALSEARCH_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Looks for a model of a Formula using stochastic local search,
+ * namely the probSAT algorithm: starting from a random assignment,
+ * a random falsified clause is picked and one of its variables is
+ * flipped, a variable being picked with a probability decreasing
+ * with its break value, i.e. the number of clauses it would
+ * falsify. It is often faster than CDCL on formulas known to be
+ * satisfiable but it cannot prove that a formula is unsatisfiable.
+ *
+ * <pre>
+ * cnf::LocalSearch ls(&f);
+ * ls.set_threads(8);
+ * ls.set_time_budget(30);
+ * if (ls.run())
+ *     x = v.extract(x_subset);
+ * </pre>
+ *
+ * Each thread runs its own search with a different seed and starts
+ * again from a random assignment every set_flips_per_try() flips;
+ * they all stop as soon as one finds a model, when the time budget is
+ * exhausted, or when the flag given to set_stop_flag() is set, so
+ * that it can run alongside other solvers.
+ *
+ * The clauses are stored in flat arrays (all the literals one after
+ * the other, and the clauses containing each literal one after the
+ * other) and the break value of each variable is kept up to date at
+ * each flip rather than computed when needed.
+ */
+    class LocalSearch
+    {
+    private:
+        /** The formula to solve. */
+        Formula * f;
+
+        /** The number of variables, i.e. the largest code used in
+         * the clauses once renamed. */
+        unsigned int n_vars;
+
+        /** The literals of all the clauses, x being 2x and -x being
+         * 2x+1. */
+        std::vector<unsigned int> literals;
+
+        /** The literals of the i-th clause are those between
+         * clause_starts[i] and clause_starts[i+1]. */
+        std::vector<unsigned int> clause_starts;
+
+        /** The clauses containing the literal l are those between
+         * occurrence_starts[l] and occurrence_starts[l+1] in
+         * `occurrences`. */
+        std::vector<unsigned int> occurrence_starts;
+
+        /** See `occurrence_starts`. */
+        std::vector<unsigned int> occurrences;
+
+        /** Is true if the formula contains the empty clause. */
+        bool has_empty_clause;
+
+        /** The number of threads used. */
+        unsigned int n_threads;
+
+        /** The seed of the first thread. */
+        unsigned long int seed;
+
+        /** The number of flips before a restart. */
+        unsigned long int flips_per_try;
+
+        /** The exponent of the break value in the probability of
+         * flipping a variable. */
+        double cb;
+
+        /** The time budget of run(), in seconds. */
+        double time_budget;
+
+        /** The value the first assignment of each thread gives to
+         * each variable: 1, -1 or 0 for a random one. */
+        std::vector<signed char> hints;
+
+        /** run() stops as soon as this flag (if any) is true. */
+        const std::atomic<bool> * stop_flag;
+
+        /** The total number of flips made by the last call to
+         * run(). */
+        unsigned long int n_flips;
+
+        /** Runs the search of one thread until a model is found or
+         * `*stop` is set. Returns true if a model is found, in which
+         * case it is stored in `model`. */
+        bool search(unsigned long int thread_seed,
+                    const std::atomic<bool> * stop,
+                    std::chrono::steady_clock::time_point deadline,
+                    std::vector<signed char> & model,
+                    unsigned long int & flips);
+
+    public:
+        /** Loads the clauses of f, which must not be modified while
+         * they are used. */
+        LocalSearch(Formula * _f);
+
+        /** Sets the number of threads used, 1 by default. */
+        void set_threads(unsigned int n);
+
+        /** Sets the seed of the random number generator. */
+        void set_seed(unsigned long int s);
+
+        /** Sets the number of flips after which a thread restarts
+         * from a random assignment, 10^6 by default. */
+        void set_flips_per_try(unsigned long int n);
+
+        /** Sets the exponent cb of the break value: a variable is
+         * chosen with a probability proportional to
+         * (1+break)^(-cb). The default, 2.3, suits 3-SAT like
+         * formulas. */
+        void set_break_exponent(double _cb);
+
+        /** Sets the time after which run() gives up, in seconds; 10 by
+         * default. */
+        void set_time_budget(double seconds);
+
+        /** Makes the first assignment tried by each thread satisfy
+         * the given literals, e.g. those of a previous model given by
+         * VariableSet::assignment(), instead of being random. */
+        void set_phases(std::vector<long int> lits);
+
+        /** Makes run() stop as soon as `*flag` is true. Give NULL to
+         * remove the flag. */
+        void set_stop_flag(const std::atomic<bool> * flag);
+
+        /** Returns true if a model is found, in which case the
+         * VariableSet is assigned accordingly; false means that none
+         * was found in time, not that there is none. */
+        bool run();
+
+        /** Prints on stdout the number of flips made by the last call
+         * to run(). */
+        void print_statistics() const;
+    };
+
+} // end namespace
+
+#endif // _LOCALSEARCH_H_
@@ -0,0 +1,275 @@
+/**
+ * @name preprocessor.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 10:12:03 leo>
+ *
+ * @brief Header of the Preprocessor class.
+ */
+
+#ifndef _CNF_PREPROCESSOR_H_
+#define _CNF_PREPROCESSOR_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Simplifies the clauses of a Formula before it is exported or
+ * solved. The following passes are available, all of them being
+ * enabled by default:
+ *
+ * + UNITS: unit propagation of the one-literal clauses, e.g. those
+ *   added by Formula::assign_to_integer();
+ * + EQUIVALENCES: detection of the literals which are equivalent
+ *   because of the binary clauses (they form a strongly connected
+ *   component of the implication graph); each of them is then
+ *   replaced by the same one in the clauses of the formula. Unlike
+ *   Formula::add_var_equality(), this does not modify the
+ *   VariableSet, which may be shared by other formulas, and frozen
+ *   variables are not replaced;
+ * + DUPLICATES: removal of duplicated literals, of tautologies and
+ *   of clauses appearing several times;
+ * + SUBSUMPTION: removal of the clauses subsumed by others and
+ *   self-subsuming resolution;
+ * + PROBING: failed literal probing, i.e. setting a literal and
+ *   propagating it to see if it leads to a conflict;
+ * + ELIMINATION: bounded variable elimination, i.e. replacing all
+ *   the clauses containing a variable by their resolvents as long as
+ *   it does not increase the number of clauses.
+ *
+ * Each pass is given a time budget (in seconds) after which it stops
+ * where it is; the formula obtained is always equivalent to the
+ * original one as far as satisfiability is concerned.
+ *
+ * The clauses are first renamed using VariableSet::new_code() so the
+ * simplified formula lives in the same variable space as the one
+ * exported by Formula::to_dimacs(). The clauses needed to assign the
+ * variables removed by the simplification are stored in the
+ * reconstruction stack of the formula and Formula::extend_model()
+ * uses them to complete the assignment read by
+ * VariableSet::parse_dimacs(). Solver::solve() does it automatically.
+ *
+ * <pre>
+ * cnf::Preprocessor p;
+ * p.set_time_budget(cnf::Preprocessor::ELIMINATION, 0.5);
+ * p.freeze(v.var("k", {0}));
+ * if (!p.run(&f))
+ *     std::cout << "UNSAT" << std::endl;
+ * </pre>
+ *
+ * Variables which are frozen are never eliminated. Freeze those you
+ * intend to put in clauses added after the preprocessing.
+ */
+    class Preprocessor
+    {
+    public:
+        /** The different simplification passes. */
+        enum Pass
+        {
+            UNITS,
+            EQUIVALENCES,
+            DUPLICATES,
+            SUBSUMPTION,
+            PROBING,
+            ELIMINATION,
+            N_PASSES
+        };
+
+    private:
+        /** Tells which passes are to be run. */
+        std::vector<bool> enabled;
+
+        /** The time budget of each pass, in seconds. */
+        std::vector<double> time_budget;
+
+        /** The maximum number of occurrences (positive and negative
+         * ones summed) of a variable for it to be eliminated. */
+        unsigned int elimination_occurrence_limit;
+
+        /** The maximum size of a resolvent created during variable
+         * elimination. */
+        unsigned int elimination_clause_limit;
+
+        /** Codes of the variables that must not be eliminated. */
+        std::vector<long int> frozen_codes;
+
+        /** The formula being simplified. */
+        Formula * f;
+
+        /** The clauses being simplified. */
+        std::vector<std::vector<long int> > clauses;
+
+        /** removed[i] is true if and only if clauses[i] is not part
+         * of the formula anymore. */
+        std::vector<bool> removed;
+
+        /** occurrences[lit_index(l)] contains the indices of the
+         * clauses containing the literal l. */
+        std::vector<std::vector<unsigned int> > occurrences;
+
+        /** The value of each variable: 0 if unassigned, 1 if true and
+         * -1 if false. */
+        std::vector<signed char> assignment;
+
+        /** The assigned literals, in chronological order. The
+         * literals at positions smaller than `n_fixed` are fixed for
+         * good, the others are temporarily set by probe(). */
+        std::vector<long int> trail;
+
+        /** The number of literals in trail which are fixed. */
+        unsigned int n_fixed;
+
+        /** is_frozen[x] is true if the variable x must be kept. */
+        std::vector<bool> is_frozen;
+
+        /** is_eliminated[x] is true if the variable x was removed
+         * from the formula. */
+        std::vector<bool> is_eliminated;
+
+        /** Used to mark literals during subsumption checks. */
+        std::vector<bool> marks;
+
+        /** Indices of clauses whose literals have changed and
+         * should be used to look for subsumptions. */
+        std::vector<unsigned int> subsumption_queue;
+
+        /** Is set to true if the formula is found unsatisfiable. */
+        bool unsat;
+
+        /** Number of clauses removed so far, counted by
+         * remove_clause(). */
+        unsigned long int n_removed_clauses;
+
+        /** Number of literals removed from clauses so far. */
+        unsigned long int n_removed_literals;
+
+        /** Number of variables fixed so far. */
+        unsigned long int n_fixed_variables;
+
+        /** Number of variables eliminated so far. */
+        unsigned long int n_eliminated_variables;
+
+        /** Number of variables merged with an equivalent one. */
+        unsigned long int n_merged_variables;
+
+        /** Time at which the current pass must stop. */
+        std::chrono::steady_clock::time_point deadline;
+
+        /** Returns the index of the literal l in the occurrences. */
+        inline unsigned int lit_index(long int l)
+        {
+            return (l > 0) ? 2*l : 2*(-l) + 1;
+        }
+
+        /** Returns the value of the literal l: 1 if true, -1 if false
+         * and 0 if its variable is unassigned. */
+        inline int lit_value(long int l)
+        {
+            return (l > 0) ? assignment[l] : -assignment[-l];
+        }
+
+        /** Starts the timer of the given pass. */
+        void start_pass(Pass p);
+
+        /** Returns true if the current pass has exceeded its time
+         * budget. */
+        bool out_of_time();
+
+        /** Loads the clauses of the formula, renaming them,
+         * removing duplicated literals and tautologies. */
+        void load();
+
+        /** Writes the clauses left and the reconstruction stack back
+         * into the formula. */
+        void store();
+
+        /** Adds a clause to the formula being simplified. Its
+         * literals must be sorted and distinct. */
+        void add(std::vector<long int> c);
+
+        /** Removes the i-th clause from the formula. */
+        void remove_clause(unsigned int i);
+
+        /** Removes the literal l from the i-th clause. */
+        void remove_literal(unsigned int i, long int l);
+
+        /** Sets the literal l to true. */
+        void assign(long int l);
+
+        /** Fixes the literal l for good and propagates all the unit
+         * clauses it creates. */
+        void fix(long int l);
+
+        /** Propagates the temporary assignment of the literals in the
+         * trail after position `start`. Returns false if a conflict
+         * is found. */
+        bool propagate(unsigned int start);
+
+        /** Cancels the temporary assignments made after the
+         * position `start` of the trail. */
+        void backtrack(unsigned int start);
+
+        /** Finds the strongly connected components of the binary
+         * implication graph, merges the equivalent literals and
+         * rewrites the clauses accordingly. */
+        void find_equivalences();
+
+        /** Removes the clauses appearing several times. */
+        void remove_duplicates();
+
+        /** Removes the subsumed clauses and performs self-subsuming
+         * resolution. */
+        void subsume();
+
+        /** Uses the clause with index i to remove or strengthen the
+         * others. */
+        void subsume_with(unsigned int i);
+
+        /** Looks for failed literals. */
+        void probe();
+
+        /** Eliminates variables using bounded variable
+         * elimination. */
+        void eliminate();
+
+        /** Tries to eliminate the variable x. Returns true if it
+         * succeeds. */
+        bool eliminate_variable(long int x);
+
+    public:
+        /** Creates a preprocessor with all passes enabled and a time
+         * budget of one second per pass. */
+        Preprocessor();
+
+        /** Enables or disables the given pass. */
+        void set_pass(Pass p, bool enable);
+
+        /** Sets the time budget (in seconds) of the given pass. */
+        void set_time_budget(Pass p, double seconds);
+
+        /** Sets the limits used by bounded variable elimination: a
+         * variable is not eliminated if it appears in more than
+         * `occurrence_limit` clauses or if it would create a
+         * resolvent longer than `clause_limit`. */
+        void set_elimination_limits(unsigned int occurrence_limit,
+                                    unsigned int clause_limit);
+
+        /** Prevents the variable with the given code (or rather the
+         * code it is renamed to) from being eliminated or replaced
+         * by an equivalent one. */
+        void freeze(long int code);
+
+        /** Simplifies the clauses of the formula f and stores the
+         * information needed to extend its models in it. Returns
+         * false if the formula is found to be unsatisfiable, in
+         * which case it is replaced by the empty clause. */
+        bool run(Formula * _f);
+
+        /** Prints on stdout the number of clauses, literals and
+         * variables removed by the last call to run(). */
+        void print_statistics();
+    };
+
+} // end namespace
+
+#endif // _PREPROCESSOR_H_
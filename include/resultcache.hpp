@@ -0,0 +1,161 @@
+/**
+ * @name resultcache.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 18:22:05 leo>
+ *
+ * @brief Header of the ResultCache class.
+ */
+
+#ifndef _CNF_RESULTCACHE_H_
+#define _CNF_RESULTCACHE_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Remembers the answers of the SAT-solvers so that a query made
+ * twice is only solved once. A query is identified by a hash of the
+ * clauses of the formula and of the assumptions, once renamed using
+ * VariableSet::new_code(); it does not depend on the order of the
+ * clauses nor on the order of the literals in them.
+ *
+ * The answers are kept in memory and, if a file is given to the
+ * constructor, appended to it so that they can be used by other
+ * processes or later runs. The models are stored as the list of the
+ * variables which are true in the VariableSet. Each answer is
+ * appended with a single write, along with its size and a checksum,
+ * so that several processes can share the file; an answer cut by a
+ * crash is dropped when the file is opened again.
+ *
+ * <pre>
+ * cnf::ResultCache cache("results.cache");
+ * cnf::Solver s("minisat", {});
+ * s.set_cache(&cache); // consulted by s.solve()
+ * </pre>
+ *
+ * It can also be used directly, e.g. with an IncrementalSolver:
+ *
+ * <pre>
+ * cnf::ResultCache::Key k = cnf::ResultCache::hash(f, assumptions);
+ * if (cache.lookup(k, &v) == cnf::ResultCache::UNKNOWN)
+ *     ...
+ * </pre>
+ *
+ * All the methods can be called from several threads.
+ */
+    class ResultCache
+    {
+    public:
+        /** The answer to a query. */
+        enum Status
+        {
+            UNKNOWN,
+            SATISFIABLE,
+            UNSATISFIABLE
+        };
+
+        /** The 128 bits hash identifying a query. */
+        struct Key
+        {
+            uint64_t low, high;
+
+            bool operator==(const Key & other) const
+            {
+                return low == other.low && high == other.high;
+            }
+        };
+
+    private:
+        /** What is known about a query. */
+        struct Entry
+        {
+            Status status;
+
+            /** The true variables if it is satisfiable, the failed
+             * assumptions otherwise. */
+            std::vector<long int> literals;
+        };
+
+        /** Hashes a Key. */
+        struct KeyHash
+        {
+            std::size_t operator()(const Key & k) const
+            {
+                return k.low ^ (k.high * 31);
+            }
+        };
+
+        /** The answers known. */
+        std::unordered_map<Key, Entry, KeyHash> entries;
+
+        /** The file in which the new answers are appended, empty if
+         * there is none. */
+        std::string path;
+
+        /** Protects the entries and the file. */
+        mutable std::mutex lock;
+
+        /** Statistics. */
+        mutable unsigned long int n_hits, n_misses;
+
+        /** Stores an entry in memory and in the file.
+         *
+         * @throw std::runtime_error if the file cannot be written. */
+        void store(const Key & k, const Entry & e);
+
+    public:
+        /** Builds a cache kept in memory only. */
+        ResultCache();
+
+        /** Builds a cache whose answers are appended to the file with
+         * the given name, after reading those it already contains.
+         *
+         * The file is truncated after the last valid answer.
+         *
+         * @throw std::runtime_error if the file exists but is not a
+         * cache file, or cannot be read or written. */
+        ResultCache(std::string _path);
+
+        /** Returns the key of the query made of the clauses of f and
+         * the given assumptions. */
+        static Key hash(const Formula & f,
+                        std::vector<long int> assumptions = std::vector<long int>());
+
+        /** Returns what is known about the query with key k. If it is
+         * satisfiable, the VariableSet v is assigned according to the
+         * model stored and VariableSet::propagate_equalities() is
+         * called; if it is not and `core` is not NULL, the failed
+         * assumptions are copied into it.
+         *
+         * The key does not depend on the reconstruction stack of a
+         * preprocessed formula, so Formula::extend_model() must be
+         * called after a successful lookup, as after solving it. */
+        Status lookup(const Key & k,
+                      VariableSet * v,
+                      std::vector<long int> * core = NULL) const;
+
+        /** Stores that the query with key k is satisfiable, the
+         * model being the current assignment of v.
+         *
+         * @throw std::runtime_error if the file cannot be written. */
+        void store_satisfiable(const Key & k, const VariableSet & v);
+
+        /** Stores that the query with key k is unsatisfiable because
+         * of the given assumptions (empty if there are none).
+         *
+         * @throw std::runtime_error if the file cannot be written. */
+        void store_unsatisfiable(const Key & k,
+                                 std::vector<long int> core = std::vector<long int>());
+
+        /** Returns the number of queries stored. */
+        unsigned long int size() const;
+
+        /** Prints on stdout the number of queries stored and the
+         * number of successful and failed lookups. */
+        void print_statistics() const;
+    };
+
+} // end namespace
+
+#endif // _RESULTCACHE_H_
@@ -0,0 +1,96 @@
+/**
+ * @name snapshot.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 19:04:41 leo>
+ *
+ * @brief Header of the Snapshot class.
+ */
+
+#ifndef _CNF_SNAPSHOT_H_
+#define _CNF_SNAPSHOT_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Saves a Formula together with its VariableSet in a binary file
+ * which can be loaded back without parsing anything: the clauses are
+ * memory mapped and used in place, so that loading a large base
+ * model takes a few milliseconds and that the processes loading the
+ * same snapshot share its pages.
+ *
+ * <pre>
+ * cnf::Snapshot::save(f, "base.snap");
+ * ...
+ * cnf::VariableSet v;
+ * cnf::Formula f(&v);
+ * cnf::Snapshot::load("base.snap", &f);
+ * f.add_clause(...); // the new clauses are stored as usual
+ * </pre>
+ *
+ * The file is made of 64-bit words in the byte order of the machine
+ * which wrote it. It starts with a header of HEADER_WORDS words:
+ *
+ * + the magic "LCNFSNAP", then the version and the size of a word
+ *   (as two 32-bit integers);
+ * + a checksum of everything after the header and the size of the
+ *   file in bytes;
+ * + the number of subsets, of equalities, of clauses, of literals,
+ *   of reconstruction clauses and of reconstruction literals.
+ *
+ * The sections follow in this order:
+ *
+ * + for each subset: the length of its name, its number of
+ *   dimensions, its name padded with zeros to a multiple of 8 bytes,
+ *   and its dimensions;
+ * + the cumulated sizes of the subsets (see VariableSet);
+ * + the equalities, as pairs (renamed variable, index of the Lit it
+ *   is renamed into);
+ * + the starts and the literals of the reconstruction stack (see
+ *   Preprocessor);
+ * + the starts and the literals of the clauses, as in the arena of a
+ *   Formula (two 32-bit literals per word, the last word being padded
+ *   with zeros).
+ *
+ * The small tables are copied in the VariableSet and in the Formula;
+ * the clauses are appended to the Formula as a read-only segment
+ * pointing into the mapping, which is released when the formula is
+ * cleared or destroyed.
+ *
+ * A snapshot is written in a temporary file which is then renamed so
+ * that the processes which have mapped a previous version of it are
+ * not disturbed.
+ */
+    class Snapshot
+    {
+    public:
+        /** The version of the format written by save(). */
+        static const uint32_t VERSION = 2;
+
+        /** The number of 64-bit words of the header. */
+        static const unsigned int HEADER_WORDS = 10;
+
+        /** Writes the formula f, its VariableSet and its
+         * reconstruction stack in the file with the given path.
+         *
+         * @throw std::runtime_error if the file cannot be written. */
+        static void save(const Formula & f, const std::string & path);
+
+        /** Loads the snapshot with the given path in the formula f
+         * and in its VariableSet, which must both be empty. If
+         * `verify` is true, the checksum is checked, which means
+         * reading the whole file.
+         *
+         * @throw std::logic_error if f or its VariableSet is not
+         * empty.
+         * @throw std::runtime_error if the file cannot be read or is
+         * not a valid snapshot. */
+        static void load(const std::string & path,
+                         Formula * f,
+                         bool verify = true);
+    };
+
+} // end namespace
+
+#endif // _SNAPSHOT_H_
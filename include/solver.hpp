@@ -35,16 +35,96 @@ namespace cnf {
 
         /** The command to call to launch the SAT-solver. */
         std::string command;
+
+        /** Is true if the SAT-solver prints the assignment on its
+         * standard output instead of writing it in a file. */
+        bool model_on_stdout;
+
+        /** The name of the file in which the phase hints are
+         * written. */
+        std::string phaseName;
+
+        /** The option telling the SAT-solver where the phase hints
+         * are, e.g. "--phase-file=". */
+        std::string phase_option;
+
+        /** The literals the SAT-solver should try to satisfy first. */
+        std::vector<long int> phase_hints;
+
+        /** The cache consulted before calling the SAT-solver, NULL if
+         * there is none. */
+        ResultCache * cache;
     public:
         /** Initializes this instance. */     
         Solver(
             std::string solverName,
             std::initializer_list<std::string> options);
 
+        /** Tells whether the SAT-solver prints the assignment on its
+         * standard output, like those following the SAT competition
+         * format (e.g. "s SATISFIABLE" and "v ..." lines), rather
+         * than writing it in a file given as its second argument,
+         * like MiniSat. Default is false. */
+        void set_model_on_stdout(bool enable);
+
+        /** Sets the literals the SAT-solver should try to satisfy
+         * first, e.g. those of a previous model given by
+         * VariableSet::assignment(). An empty vector removes the
+         * hints.
+         *
+         * Before each call, they are written in the file phaseName as
+         * a single line "v l1 l2 ... 0", i.e. the model format of the
+         * SAT competitions: li is the number of a variable in the
+         * DIMACS file given to the SAT-solver, negated if it should
+         * be false. The variables which are not in that file are
+         * left out. The command becomes
+         *
+         * <pre>
+         * solverName options... <option><phaseName> <inputName> ...
+         * </pre>
+         *
+         * where nothing separates `option` from the path, so that
+         * both "--phase-file=" and "-phases " work.
+         *
+         * The common SAT-solvers (MiniSat, Glucose, CaDiCaL, Kissat,
+         * CryptoMiniSat) do not read such a file: `solverName` must
+         * then be a wrapper (or a patched solver) turning it into the
+         * solver's own way of setting the initial phases. The
+         * solvers of this library, IncrementalSolver::set_phases()
+         * and LocalSearch::set_phases(), take the literals
+         * directly. */
+        void set_phase_hints(std::vector<long int> lits, std::string option);
+
+        /** Makes solve() look for the answer in the given cache before
+         * calling the SAT-solver, and store it there afterwards. Give
+         * NULL to stop using it. */
+        void set_cache(ResultCache * _cache);
+
+        /** Makes solve() write the DIMACS file given to the
+         * SAT-solver compressed with the given codec, which the
+         * SAT-solver must be able to read (most read ".gz" and ".xz"
+         * files directly). Default is Compression::NONE.
+         *
+         * @throw std::runtime_error if the codec is not available. */
+        void set_compression(Compression::Codec codec);
+
         /** Solves the given Formula f. If it is satisfiable, returns
          * true and assigns the variables in the VariableSet v
-         * accordingly. Otherwise, returns False. */
+         * accordingly. Otherwise, returns False.
+         *
+         * The answer is stored in the cache (see set_cache()) only if
+         * the SAT-solver exits with the usual code: 10 if the formula
+         * is satisfiable, 20 if it is not.
+         *
+         * @throw std::runtime_error if the SAT-solver cannot be
+         * started, is killed or does not write its output. */
         bool solve(Formula f, VariableSet * v);
+
+        /** Same as above but the formula is not copied. It is
+         * exported with Formula::to_dimacs_file() so that, when it is
+         * solved again by this solver after clauses were added to
+         * it, only these are written in the DIMACS file. */
+        bool solve(Formula * f, VariableSet * v);
     };
 } // closing namespace
 
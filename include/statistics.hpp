@@ -0,0 +1,161 @@
+/**
+ * @name statistics.hpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 20:52:19 leo>
+ *
+ * @brief Header of the Statistics class.
+ */
+
+#ifndef _CNF_STATISTICS_H_
+#define _CNF_STATISTICS_H_
+
+#include "libcnf.hpp"
+
+namespace cnf {
+
+/**
+ * Collects figures about the construction and the resolution of the
+ * formulas when the library is compiled with LIBCNF_STATS defined
+ * (cmake -DLIBCNF_STATS=ON):
+ *
+ * + the number of clauses and literals added to the formulas, tagged
+ *   by the generator which added them (see Source);
+ * + the histogram of the lengths of these clauses;
+ * + the number of calls and the time spent in each Phase;
+ * + the largest memory footprint reached by a Formula and by a
+ *   VariableSet.
+ *
+ * <pre>
+ * ... // build and solve
+ * cnf::Statistics::global().to_json(&std::cout);
+ * </pre>
+ *
+ * The library only updates the statistics through the LIBCNF_SOURCE,
+ * LIBCNF_TIMER, LIBCNF_COUNT_CLAUSE and LIBCNF_MEMORY macros, which
+ * expand to nothing when LIBCNF_STATS is not defined; the class
+ * itself is always there and then reports zeros. The counters are
+ * atomic so that they can be updated from several threads.
+ */
+    class Statistics
+    {
+    public:
+        /** The generators adding clauses to a formula. */
+        enum Source
+        {
+            USER,
+            SBOX,
+            XOR,
+            EQUALITY,
+            TEMPLATE,
+            INTERNAL,
+            N_SOURCES
+        };
+
+        /** The phases which are timed. */
+        enum Phase
+        {
+            EXPORT,
+            SPAWN,
+            PARSE,
+            SOLVE,
+            PREPROCESS,
+            N_PHASES
+        };
+
+        /** The objects whose memory footprint is recorded. */
+        enum Footprint
+        {
+            FORMULA,
+            VARIABLE_SET,
+            N_FOOTPRINTS
+        };
+
+        /** Clauses longer than this are counted together in the
+         * histogram. */
+        static const unsigned int MAX_LENGTH = 64;
+
+        /** Sets the source of the clauses added by the current thread
+         * while it exists. */
+        class SourceScope
+        {
+        private:
+            Source previous;
+        public:
+            SourceScope(Source s);
+            ~SourceScope();
+        };
+
+        /** Adds the time elapsed between its construction and its
+         * destruction to a phase. */
+        class ScopedTimer
+        {
+        private:
+            Phase phase;
+            std::chrono::steady_clock::time_point start;
+        public:
+            ScopedTimer(Phase p);
+            ~ScopedTimer();
+        };
+
+    private:
+        std::atomic<unsigned long int> n_clauses[N_SOURCES];
+        std::atomic<unsigned long int> n_literals[N_SOURCES];
+        std::atomic<unsigned long int> lengths[MAX_LENGTH + 1];
+        std::atomic<unsigned long int> n_calls[N_PHASES];
+        std::atomic<unsigned long int> nanoseconds[N_PHASES];
+        std::atomic<unsigned long int> peak_bytes[N_FOOTPRINTS];
+
+        /** The source of the clauses added by each thread. */
+        static thread_local Source current_source;
+
+        Statistics();
+
+    public:
+        /** Returns the statistics of the library. */
+        static Statistics & global();
+
+        /** Counts a clause of the given length added by the current
+         * source. */
+        void count_clause(unsigned long int length);
+
+        /** Counts a call to the given phase which took the given
+         * time. */
+        void count_phase(Phase p, std::chrono::steady_clock::duration d);
+
+        /** Records that an object has reached the given size in
+         * bytes. */
+        void record_memory(Footprint k, unsigned long int bytes);
+
+        /** Returns true if the library was compiled with
+         * LIBCNF_STATS. */
+        static bool enabled();
+
+        /** Sets all the statistics to zero. */
+        void reset();
+
+        /** Writes the statistics on the given stream as a JSON
+         * object. */
+        void to_json(std::ostream * out) const;
+    };
+
+} // end namespace
+
+#ifdef LIBCNF_STATS
+#define LIBCNF_CONCAT_(a, b) a ## b
+#define LIBCNF_CONCAT(a, b) LIBCNF_CONCAT_(a, b)
+#define LIBCNF_SOURCE(s) cnf::Statistics::SourceScope \
+    LIBCNF_CONCAT(libcnf_source_, __LINE__)(cnf::Statistics::s)
+#define LIBCNF_TIMER(p) cnf::Statistics::ScopedTimer \
+    LIBCNF_CONCAT(libcnf_timer_, __LINE__)(cnf::Statistics::p)
+#define LIBCNF_COUNT_CLAUSE(length) \
+    cnf::Statistics::global().count_clause(length)
+#define LIBCNF_MEMORY(k, bytes) \
+    cnf::Statistics::global().record_memory(cnf::Statistics::k, bytes)
+#else
+#define LIBCNF_SOURCE(s) ((void)0)
+#define LIBCNF_TIMER(p) ((void)0)
+#define LIBCNF_COUNT_CLAUSE(length) ((void)0)
+#define LIBCNF_MEMORY(k, bytes) ((void)0)
+#endif
+
+#endif // _STATISTICS_H_
@@ -13,6 +13,176 @@
 
 namespace cnf {
 
+/**
+ * A range of consecutive variable codes, e.g. a row of a subset
+ * returned by Subset::slice(). */
+    class CodeRange
+    {
+    private:
+        /** The first code of the range. */
+        long int first_code;
+
+        /** The number of codes in the range. */
+        unsigned long int length;
+    public:
+        /** Builds the range [first, first+n-1]. */
+        CodeRange(long int first, unsigned long int n)
+            : first_code(first), length(n) {}
+
+        /** Returns the i-th code of the range. */
+        long int operator[](unsigned long int i) const
+        {
+            return first_code + i;
+        }
+
+        /** Returns the number of codes in the range. */
+        unsigned long int size() const
+        {
+            return length;
+        }
+
+        /** Returns the codes of the range in a vector, as expected by
+         * e.g. Sbox::add_clauses_image(). */
+        std::vector<long int> codes() const
+        {
+            std::vector<long int> result(length);
+            for (unsigned long int i=0; i<length; i++)
+                result[i] = first_code + i;
+            return result;
+        }
+    };
+
+/**
+ * The numbering of the variables in a DIMACS file: the variable i of
+ * the file has code code(i). It is returned by Formula::to_dimacs()
+ * and Formula::to_dimacs_file(), which renumber the variables
+ * densely, and must be given back to VariableSet::parse_dimacs() to
+ * read the model of this very file:
+ *
+ * <pre>
+ * cnf::DimacsNumbering numbering = f.to_dimacs_file("in.cnf");
+ * ... // solving in.cnf, the model being written in out.txt
+ * v.parse_dimacs_file("out.txt", numbering);
+ * </pre>
+ *
+ * The default numbering is the identity, i.e. the file uses the
+ * codes themselves. */
+    class DimacsNumbering
+    {
+    private:
+        /** The variable i of the file has code codes[i-1]. Is empty
+         * for the identity. */
+        std::vector<long int> codes;
+    public:
+        /** Builds the identity. */
+        DimacsNumbering() {}
+
+        /** Builds the numbering where the variable i of the file has
+         * code _codes[i-1]. */
+        explicit DimacsNumbering(std::vector<long int> _codes)
+            : codes(_codes) {}
+
+        /** Returns true if the file uses the codes themselves. */
+        bool is_identity() const
+        {
+            return codes.empty();
+        }
+
+        /** Returns the number of variables of the file, 0 for the
+         * identity. */
+        unsigned long int size() const
+        {
+            return codes.size();
+        }
+
+        /** Returns the code of the variable i of the file, 0 if it
+         * has none. */
+        unsigned long int code(unsigned long int i) const
+        {
+            if (codes.empty())
+                return i;
+            return (i >= 1 && i <= codes.size()) ? codes[i-1] : 0;
+        }
+    };
+
+/**
+ * A handle on a subset of a VariableSet, as returned by
+ * VariableSet::add_subset() and VariableSet::subset(). It computes the
+ * code of a variable from its coordinates using a multiply-add per
+ * coordinate, without looking up the name of the subset:
+ *
+ * <pre>
+ * cnf::Subset y = v.add_subset("y", {7, 3, 3});
+ * code_y_5_2_1 = y(5, 2, 1); // same as v.var("y", {5, 2, 1})
+ * </pre>
+ *
+ * Contrary to VariableSet::var(), the coordinates are not checked:
+ * giving the wrong number of coordinates or a coordinate which is too
+ * large silently returns the code of another variable.
+ */
+    class Subset
+    {
+    private:
+        /** The code of the variable whose coordinates are all 0. */
+        long int first_code;
+
+        /** strides[i] is the difference between the codes of two
+         * variables whose i-th coordinates differ by one. */
+        std::vector<long int> strides;
+
+        /** The dimensions of the subset. */
+        std::vector<unsigned int> dimensions;
+
+        /** The number of variables in the subset. */
+        unsigned long int n_variables;
+
+        /** Ends the recursion of offset(). */
+        long int offset(unsigned int) const
+        {
+            return 0;
+        }
+
+        /** Returns the offset of the variable with the given
+         * coordinates, starting with the d-th one. */
+        template <typename... Rest>
+        long int offset(unsigned int d, unsigned int i, Rest... rest) const
+        {
+            return i*strides[d] + offset(d+1, rest...);
+        }
+    public:
+        /** Builds an empty handle. */
+        Subset() : first_code(0), n_variables(0) {}
+
+        /** Builds the handle of a subset whose first variable has the
+         * given code and with the given dimensions. */
+        Subset(long int first, const std::vector<unsigned int> & dim);
+
+        /** Returns the code of the variable with the given
+         * coordinates. */
+        template <typename... Indices>
+        long int operator()(Indices... idx) const
+        {
+            return first_code + offset(0, idx...);
+        }
+
+        /** Returns the codes of the variables whose first coordinates
+         * are those given, e.g. the row {i} of a two-dimensional
+         * subset or the whole subset for {}. These codes are
+         * consecutive.
+         *
+         * @throw std::domain_error if there are too many
+         * coordinates.
+         * @throw std::out_of_range if one of the coordinate is too
+         * large */
+        CodeRange slice(std::initializer_list<unsigned int> prefix) const;
+
+        /** Returns the number of variables in the subset. */
+        unsigned long int size() const
+        {
+            return n_variables;
+        }
+    };
+
 /**
  * This class provides an easy way to give every literal a unique
  * code, assign values to them from the DIMACS output of a SAT-solver;
@@ -38,6 +208,15 @@ namespace cnf {
  * code_y_5_2_1 = v.var("y", {5, 2, 1});
  * </pre>
  *
+ * In the innermost loops of a model, use a Subset handle instead: it
+ * avoids looking up the name of the subset and checking the
+ * coordinates.
+ *
+ * <pre>
+ * cnf::Subset y = v.subset("y");
+ * code_y_5_2_1 = v.var(y, 5, 2, 1); // or simply y(5, 2, 1)
+ * </pre>
+ *
  * Each variable subset (x and y in the previous example) is given an
  * a number when add_subset is called; here 0 for x and 1 for y. These
  * numbers are stored in the map `subset_indices`. The dimensions of
@@ -58,8 +237,10 @@ namespace cnf {
  * the end of a clause so it is not a valid index either.
  *
  * Finally, variables value can be read from a DIMACS file. Their
- * values are stored in the `values` vector of bool and the value of
- * each variable can be retrieved using the `value` method.
+ * values are packed in the `values` vector of 64-bit words and the
+ * value of each variable can be retrieved using the `value` method;
+ * those of a whole subset or row can be extracted at once as words
+ * using `extract`.
  */
     class VariableSet
     {
@@ -76,16 +257,78 @@ namespace cnf {
          * having an index smaller than a constant. */
         std::vector<unsigned int> subset_cumulated_sizes;
 
-        /** The values of the variables (known). */
-        std::vector<bool> values;
+        /** The handles of the subsets. */
+        std::vector<Subset> subset_handles;
+
+        /** Returns the index of the subset with the given name.
+         *
+         * @throw std::domain_error if there is no such subset. */
+        unsigned int subset_index(const std::string & name) const;
+
+        /** What is carried from a block of the output of a SAT-solver
+         * to the next one: the numbering of its variables, the codes
+         * of the variables to assign and what was found so far. */
+        struct ModelParsing;
+
+        /** Parses the part of the output of a SAT-solver stored in
+         * memory between `begin` and `end` (see parse_dimacs()),
+         * which ends at the end of a line. */
+        void parse_model(const char * begin,
+                         const char * end,
+                         ModelParsing & m);
+
+        /** Stores the model once the whole output was parsed and
+         * returns true if there is one. */
+        bool end_model(ModelParsing & m);
+
+        /** Maps the file with the given name in memory and parses it
+         * using parse_model(), by blocks if it is compressed. If
+         * `wanted` is not NULL, only the variables with these codes
+         * are assigned. */
+        bool parse_file(const std::string & path,
+                        const DimacsNumbering & numbering,
+                        const std::vector<long int> * wanted);
+
+        /** Same as above but reads the output from a stream. */
+        bool parse_stream(std::istream * input,
+                          const DimacsNumbering & numbering,
+                          const std::vector<long int> * wanted);
+
+        /** The values of the variables (known): the value of the
+         * variable with code x is the bit (x-1)%64 of the word
+         * (x-1)/64. */
+        std::vector<uint64_t> values;
+
+        /** Returns the value of the variable with code x. */
+        inline bool bit(unsigned long int x) const
+        {
+            return (values[(x-1) >> 6] >> ((x-1) & 63)) & 1;
+        }
+
+        /** Sets the value of the variable with code x. */
+        inline void set_bit(unsigned long int x, bool b)
+        {
+            uint64_t mask = ((uint64_t)1) << ((x-1) & 63);
+            if (b)
+                values[(x-1) >> 6] |= mask;
+            else
+                values[(x-1) >> 6] &= ~mask;
+        }
         
         /** Is true if and only if the variables have received an
          * assignment. */
         bool vars_are_assigned;
 
         /** Stores the correspondance between variables known to be
-         * equal. */
-        std::map<long int, long int> var_equalities;
+         * equal: equalities[x] is the literal the variable with code
+         * x is renamed into, Lit() if it is not renamed (or if x is
+         * past the end of the table). */
+        std::vector<Lit> equalities;
+
+        /** The number of variables renamed in `equalities`. */
+        unsigned long int n_renamed;
+
+        friend class Snapshot;
         
     public:
         /** @name Construction
@@ -98,9 +341,14 @@ namespace cnf {
         /** Adds a subset of variable with the given name and
          * dimensions. If dim = {3, 5} then the possible indices are
          * in [0,2]x[0,4] (3 possible values for the first, 5 for the
-         * second).*/
-        void add_subset(
-            std::string name,
+         * second).
+         *
+         * @return A handle on the subset just added.
+         *
+         * @throw std::length_error if the set would have more than
+         * Var::MAX_CODE variables. */
+        Subset add_subset(
+            const std::string & name,
             std::initializer_list<unsigned int > dim);
 
         /** Adds a new subset of variables using a new name chosen at
@@ -119,27 +367,60 @@ namespace cnf {
          *
          * Raises an exception if the coordinates are not valid.
          * 
-         * @throw std::domain_error if there are too many coordinates.
+         * @throw std::domain_error if there is no subset with this
+         * name or if there are too many coordinates.
          * @throw std::out_of_range if one of the coordinate is too
          * large */
         long int var(
-            std::string name,
-            std::initializer_list<unsigned int > coord);
+            const std::string & name,
+            std::initializer_list<unsigned int > coord) const;
+
+        /** Returns the code of the variable with the given
+         * coordinates in the subset h. The coordinates are not
+         * checked, see Subset. */
+        template <typename... Indices>
+        long int var(const Subset & h, Indices... idx) const
+        {
+            return h(idx...);
+        }
+
+        /** Returns the handle of the subset with the given name.
+         *
+         * @throw std::domain_error if there is no such subset. */
+        Subset subset(const std::string & name) const;
+
+        /** Returns the codes of the variables of the subset with the
+         * given name whose first coordinates are those given (see
+         * Subset::slice()).
+         *
+         * @throw std::domain_error if there is no such subset or if
+         * there are too many coordinates.
+         * @throw std::out_of_range if one of the coordinate is too
+         * large */
+        CodeRange slice(
+            const std::string & name,
+            std::initializer_list<unsigned int> prefix) const;
 
         /** Returns the code to be used for this variable knowing that
          * it may be equal to other variables. */
-        long int new_code(long int old_code);
+        long int new_code(long int old_code) const;
+
+        /** Same as above for a literal stored on 32 bits. */
+        Lit new_code(Lit old_lit) const;
 
         /** Returns the code of the variable with given name and
          * coordinates by taking into account that it may be equal to
          * other variables.  */
         long int new_code(
-            std::string old_name,
-            std::initializer_list<unsigned int> old_coord);
+            const std::string & old_name,
+            std::initializer_list<unsigned int> old_coord) const;
 
         /** Tells the variable set that the two variables given are
          * equal so that a unique code should be used for both of
-         * them. */
+         * them.
+         *
+         * @throw std::logic_error if x1 is already known to be
+         * equal to no(x2). */
         void add_var_equality(long int x1, long int x2);
         
         ///@}
@@ -170,10 +451,52 @@ namespace cnf {
          * v.parse_dimacs(&some_stream);
          * </pre>
          *
+         * If the formula was written using a dense numbering of the
+         * variables, the numbering returned by Formula::to_dimacs()
+         * must be given so that the variables of the file are mapped
+         * back to their codes.
+         *
+         * Both the output of MiniSat (a line "SAT" or "UNSAT"
+         * followed by the list of literals) and the one used in SAT
+         * competitions (comment lines starting with "c", a status
+         * line "s SATISFIABLE" or "s UNSATISFIABLE" and the literals
+         * on lines starting with "v") are understood, compressed or
+         * not; a compressed output is decompressed and parsed one
+         * block after the other (see Compression::Input).
+         *
          * @throw std::logic_error if the VariableSet instance
          * contains no subset.
+         *
+         * @throw std::runtime_error if the assignment contains a
+         * variable which does not exist.
          */
-        bool parse_dimacs(std::istream * input);
+        bool parse_dimacs(std::istream * input,
+                          const DimacsNumbering & numbering = DimacsNumbering());
+
+        /** Works like parse_dimacs(input, numbering) but only assigns
+         * the variables whose codes are in `wanted`, which is faster
+         * for large models. The value of the other variables is not
+         * defined: this cannot be used with a preprocessed formula
+         * since Formula::extend_model() needs all of them. */
+        bool parse_dimacs(std::istream * input,
+                          const std::vector<long int> & wanted,
+                          const DimacsNumbering & numbering = DimacsNumbering());
+
+        /** Works like parse_dimacs() but reads the file with the given
+         * name directly by mapping it in memory.
+         *
+         * @throw std::runtime_error if the file cannot be read. */
+        bool parse_dimacs_file(const std::string & path,
+                               const DimacsNumbering & numbering = DimacsNumbering());
+
+        /** Works like parse_dimacs(input, wanted, numbering) but
+         * reads the file with the given name directly by mapping it
+         * in memory.
+         *
+         * @throw std::runtime_error if the file cannot be read. */
+        bool parse_dimacs_file(const std::string & path,
+                               const std::vector<long int> & wanted,
+                               const DimacsNumbering & numbering = DimacsNumbering());
 
         /**
          * Returns the value of the variable with the given names
@@ -182,8 +505,8 @@ namespace cnf {
          * @throw std::logic_error if the variables have not been
          * assigned yet. */
         bool value(
-            std::string name,
-            std::initializer_list<unsigned int > coord);
+            const std::string & name,
+            std::initializer_list<unsigned int > coord) const;
 
         /** Returns the little endian representation of the brace
          * enclosed list of bits corresponding to the assignment of
@@ -191,7 +514,7 @@ namespace cnf {
          *
          * @throw std::logic_error if the variables have not been
          * assigned yet. */
-        uint32_t little_endian(std::initializer_list<long int> vars);
+        uint32_t little_endian(std::initializer_list<long int> vars) const;
         
         /** Returns the little endian representation of the vector of
          * bits corresponding to the assignment of the variables given
@@ -199,7 +522,78 @@ namespace cnf {
          *
          * @throw std::logic_error if the variables have not been
          * assigned yet. */
-        uint32_t little_endian(std::vector<long int> vars);
+        uint32_t little_endian(std::vector<long int> vars) const;
+
+        /** Returns the values of the variables with the given
+         * consecutive codes packed in 64-bit words: the value of
+         * codes[i] is the bit i%64 of the word i/64. The words are
+         * obtained using shifts of the packed assignment so this is
+         * much faster than reading the variables one by one.
+         *
+         * @throw std::logic_error if the variables have not been
+         * assigned yet.
+         * @throw std::out_of_range if the codes are not in the
+         * variable set. */
+        std::vector<uint64_t> extract(const CodeRange & codes) const;
+
+        /** Returns the values of all the variables of the given
+         * subset packed in 64-bit words (see extract(CodeRange)). */
+        std::vector<uint64_t> extract(const Subset & h) const;
+
+        /** Returns the values of the variables with the given
+         * consecutive codes as a bitset: bit i is the value of
+         * codes[i]. Only the first N codes are used. */
+        template <std::size_t N>
+        std::bitset<N> extract_bitset(const CodeRange & codes) const
+        {
+            std::vector<uint64_t> words = extract(codes);
+            std::bitset<N> result;
+            for (unsigned int w=words.size(); w>0; w--)
+            {
+                result <<= (N > 64) ? 64 : N;
+                result |= std::bitset<N>(words[w-1]);
+            }
+            return result;
+        }
+
+        /** Returns true if and only if the literal with the given
+         * code is satisfied by the current assignment.
+         *
+         * @throw std::logic_error if the variables have not been
+         * assigned yet.
+         *
+         * @throw std::out_of_range if the variable is not in the
+         * set. */
+        bool literal_value(long int lit) const;
+
+        /** Assigns false to all the variables so that an assignment
+         * can be built using set_literal(), e.g. from the model of an
+         * IncrementalSolver. */
+        void clear_assignment();
+
+        /** Modifies the current assignment so that the literal with
+         * the given code is satisfied. Used to extend the model
+         * returned by a SAT-solver to variables it never saw.
+         *
+         * @throw std::logic_error if the variables have not been
+         * assigned yet.
+         *
+         * @throw std::out_of_range if the variable is not in the
+         * set. */
+        void set_literal(long int lit);
+
+        /** Gives to every variable renamed through `equalities`
+         * the value of the variable whose code was used instead of
+         * its own. Called at the end of parse_dimacs(). */
+        void propagate_equalities();
+
+        /** Returns the literals satisfied by the current assignment,
+         * one per variable (x if x is true and -x otherwise), e.g. to
+         * give them as phase hints to the next solver.
+         *
+         * @throw std::logic_error if the variables have not been
+         * assigned yet. */
+        std::vector<long int> assignment() const;
         
         ///@}
         /** @name Retrieving data
@@ -219,7 +613,16 @@ namespace cnf {
 
         /** Return the total size of the variable set, i.e. the sum of
          * the sizes of the subsets. */
-        unsigned long int size();
+        unsigned long int size() const;
+
+        /** Returns the number of variables renamed into others, i.e.
+         * of calls to add_var_equality() which merged two
+         * variables. */
+        unsigned long int n_equalities() const;
+
+        /** Returns an estimate of the memory used by the variable set
+         * in bytes. */
+        unsigned long int memory_usage() const;
 
         /** Returns the upper-bound of the n-th index of the variable
          * with the given name.
@@ -235,8 +638,8 @@ namespace cnf {
          *
          * @throw std::domain_error if n is too large. */
         unsigned int subset_index_bound(
-            std::string name,
-            unsigned int n);
+            const std::string & name,
+            unsigned int n) const;
 
         ///@}
     };
@@ -0,0 +1,137 @@
+/**
+ * @name backbone.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 15:21:48 leo>
+ *
+ * @brief Source code of the Backbone class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+Backbone::Backbone(Formula * _f) :
+    f(_f),
+    solver(_f->variables()),
+    chunk_size(16),
+    n_calls(0)
+{
+    solver.add_formula(*f);
+}
+
+
+void Backbone::set_chunk_size(unsigned int n)
+{
+    chunk_size = (n > 0) ? n : 1;
+}
+
+
+void Backbone::filter(std::vector<unsigned int> & candidates)
+{
+    unsigned int j = 0;
+    for (unsigned int i=0; i<candidates.size(); i++)
+        if (solver.model_value(literals[candidates[i]]))
+            candidates[j++] = candidates[i];
+    candidates.resize(j);
+}
+
+
+void Backbone::set_forced(unsigned int i)
+{
+    status[i] = (literals[i] > 0) ? 1 : -1;
+    solver.add_clause(Clause{literals[i]});
+}
+
+
+bool Backbone::run(std::vector<long int> _codes)
+{
+    codes = _codes;
+    status.assign(codes.size(), 0);
+    literals.resize(codes.size());
+    n_calls = 1;
+    if (!solver.solve())
+        return false;
+    std::vector<unsigned int> candidates, postponed;
+    for (unsigned int i=0; i<codes.size(); i++)
+    {
+        literals[i] = solver.model_value(codes[i]) ? codes[i] : no(codes[i]);
+        candidates.push_back(i);
+    }
+
+    while (!candidates.empty())
+    {
+        unsigned int n = std::min((unsigned int)candidates.size(), chunk_size);
+        std::vector<unsigned int> chunk(candidates.end()-n, candidates.end());
+        candidates.resize(candidates.size()-n);
+        while (!chunk.empty())
+        {
+            std::vector<long int> assumed;
+            for (unsigned int i=0; i<chunk.size(); i++)
+                assumed.push_back(no(literals[chunk[i]]));
+            n_calls ++;
+            if (solver.solve(assumed))
+            {
+                // All the literals of the chunk are falsified by the
+                // model.
+                chunk.clear();
+                filter(candidates);
+                filter(postponed);
+                continue;
+            }
+            std::vector<long int> core = solver.failed_assumptions();
+            if (core.empty())
+                return true;
+            std::vector<unsigned int> rest;
+            for (unsigned int i=0; i<chunk.size(); i++)
+                if (std::find(core.begin(), core.end(), no(literals[chunk[i]]))
+                    == core.end())
+                    rest.push_back(chunk[i]);
+                else if (core.size() == 1)
+                    set_forced(chunk[i]);
+                else
+                    postponed.push_back(chunk[i]);
+            chunk.swap(rest);
+        }
+    }
+
+    // The candidates which were part of a larger core are checked
+    // one by one.
+    while (!postponed.empty())
+    {
+        unsigned int i = postponed.back();
+        postponed.pop_back();
+        n_calls ++;
+        if (solver.solve({no(literals[i])}))
+            filter(postponed);
+        else
+            set_forced(i);
+    }
+    return true;
+}
+
+
+std::vector<long int> Backbone::forced_literals() const
+{
+    std::vector<long int> result;
+    for (unsigned int i=0; i<codes.size(); i++)
+        if (status[i] != 0)
+            result.push_back((status[i] > 0) ? codes[i] : no(codes[i]));
+    return result;
+}
+
+
+std::vector<long int> Backbone::free_codes() const
+{
+    std::vector<long int> result;
+    for (unsigned int i=0; i<codes.size(); i++)
+        if (status[i] == 0)
+            result.push_back(codes[i]);
+    return result;
+}
+
+
+unsigned long int Backbone::solver_calls() const
+{
+    return n_calls;
+}
@@ -13,11 +13,13 @@ using namespace cnf;
 
 Clause::Clause()
 {
+    normalized = false;
 }
 
 
 Clause::Clause(std::initializer_list<long int> lit_codes)
 {
+    normalized = false;
     unsigned int i = 0;
     literals.resize(lit_codes.size());
     for (auto lit = lit_codes.begin(); lit != lit_codes.end(); lit++)
@@ -27,14 +29,30 @@ Clause::Clause(std::initializer_list<long int> lit_codes)
     }
 }
 
+Clause::Clause(std::vector<long int> lit_codes)
+{
+    normalized = false;
+    literals = lit_codes;
+}
+
+
 const long int& Clause::operator[](const unsigned int i) const
 {
     return literals[i];
 }
 
 
-int Clause::variable_index(long int x)
+int Clause::variable_index(long int x) const
 {
+    if (normalized)
+    {
+        long int var = (x > 0) ? x : (-1)*x;
+        auto it = std::lower_bound(literals.begin(), literals.end(),
+                                   var, literal_order);
+        if (it != literals.end() && (*it == var || *it == no(var)))
+            return it - literals.begin();
+        return -1;
+    }
     for (unsigned int i=0; i<literals.size(); i++)
         if (literals[i] == x || literals[i] == -x)
             return i;
@@ -42,7 +60,7 @@ int Clause::variable_index(long int x)
 }
 
 
-unsigned int Clause::size()
+unsigned int Clause::size() const
 {
     return literals.size();
 }
@@ -51,4 +69,18 @@ unsigned int Clause::size()
 void Clause::push_back(long int x)
 {
     literals.push_back(x);
+    normalized = false;
+}
+
+
+bool Clause::normalize()
+{
+    std::sort(literals.begin(), literals.end(), literal_order);
+    literals.erase(std::unique(literals.begin(), literals.end()),
+                   literals.end());
+    normalized = true;
+    for (unsigned int i=1; i<literals.size(); i++)
+        if (literals[i] == no(literals[i-1]))
+            return false;
+    return true;
 }
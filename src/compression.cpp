@@ -0,0 +1,859 @@
+/**
+ * @name compression.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 22:58:30 leo>
+ *
+ * @brief Source code of the Compression class.
+ */
+
+#ifdef LIBCNF_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef LIBCNF_HAVE_LZMA
+#include <lzma.h>
+#endif
+#ifdef LIBCNF_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+/** The number of bytes given at once to an encoder. */
+static const unsigned long int BLOCK_SIZE = 1 << 22;
+
+/** The presets used for each codec. */
+static const int GZIP_LEVEL = 6, XZ_PRESET = 1, ZSTD_LEVEL = 3;
+
+
+// !SECTION! Codecs
+// ================
+
+bool Compression::available(Codec codec)
+{
+    switch (codec)
+    {
+    case NONE:
+        return true;
+    case GZIP:
+#ifdef LIBCNF_HAVE_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case XZ:
+#ifdef LIBCNF_HAVE_LZMA
+        return true;
+#else
+        return false;
+#endif
+    case ZSTD:
+#ifdef LIBCNF_HAVE_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+
+/** Throws an exception if the given codec is not available. */
+static void check_available(Compression::Codec codec)
+{
+    if (!Compression::available(codec))
+        throw std::runtime_error(
+            "libcnf was built without support for the "
+            + Compression::extension(codec) + " files.");
+}
+
+
+/** Returns true if `s` ends with `suffix`. */
+static bool ends_with(const std::string & s, const std::string & suffix)
+{
+    return s.size() >= suffix.size()
+        && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+
+Compression::Codec Compression::of_path(const std::string & path)
+{
+    if (ends_with(path, ".gz"))
+        return GZIP;
+    else if (ends_with(path, ".xz"))
+        return XZ;
+    else if (ends_with(path, ".zst"))
+        return ZSTD;
+    else
+        return NONE;
+}
+
+
+/** Returns true if the data between `begin` and `end` starts with the
+ * `n` bytes of `magic`. */
+static bool starts_with(const char * begin,
+                        const char * end,
+                        const char * magic,
+                        unsigned int n)
+{
+    return end - begin >= n && memcmp(begin, magic, n) == 0;
+}
+
+
+Compression::Codec Compression::of_content(const char * begin, const char * end)
+{
+    if (starts_with(begin, end, "\x1f\x8b", 2))
+        return GZIP;
+    else if (starts_with(begin, end, "\xfd" "7zXZ\0", 6))
+        return XZ;
+    else if (starts_with(begin, end, "\x28\xb5\x2f\xfd", 4))
+        return ZSTD;
+    else
+        return NONE;
+}
+
+
+std::string Compression::extension(Codec codec)
+{
+    switch (codec)
+    {
+    case GZIP:
+        return ".gz";
+    case XZ:
+        return ".xz";
+    case ZSTD:
+        return ".zst";
+    default:
+        return "";
+    }
+}
+
+
+// !SECTION! Decompression
+// =======================
+
+/** The number of bytes of compressed data read at once from a
+ * stream, and of decompressed data produced at once. */
+static const unsigned long int DECODER_BLOCK_SIZE = 1 << 20;
+
+
+/**
+ * A stream buffer decompressing data taken either from memory or
+ * from a stream, DECODER_BLOCK_SIZE bytes at a time.
+ */
+class Decoder : public std::streambuf
+{
+protected:
+    /** The compressed data not given to the codec yet. */
+    const char * in_begin, * in_end;
+
+    /** The stream the compressed data comes from, NULL if it is
+     * all in memory. */
+    std::istream * source;
+
+    /** Holds the data read from `source`. */
+    std::vector<char> in_buffer;
+
+    /** Holds the decompressed data. */
+    std::vector<char> out_buffer;
+
+    /** Makes `in_begin` and `in_end` delimit the next compressed
+     * data. Returns false if there is none left. */
+    bool refill()
+    {
+        if (source == NULL)
+            return false;
+        source->read(in_buffer.data(), in_buffer.size());
+        in_begin = in_buffer.data();
+        in_end = in_begin + source->gcount();
+        return in_begin != in_end;
+    }
+
+    /** Decompresses at most n bytes in `out` and returns how many
+     * were written, 0 at the end of the data. */
+    virtual std::size_t decode(char * out, std::size_t n) = 0;
+
+    int underflow()
+    {
+        if (gptr() < egptr())
+            return traits_type::to_int_type(*gptr());
+        std::size_t n = decode(out_buffer.data(), out_buffer.size());
+        if (n == 0)
+            return traits_type::eof();
+        setg(out_buffer.data(), out_buffer.data(), out_buffer.data() + n);
+        return traits_type::to_int_type(*gptr());
+    }
+
+public:
+    /** Takes the compressed data between `begin` and `end`, then
+     * what is read from `_source` if it is not NULL. */
+    Decoder(const char * begin, const char * end, std::istream * _source)
+        : in_begin(begin), in_end(end),
+          source(_source),
+          in_buffer((_source != NULL) ? DECODER_BLOCK_SIZE : 0),
+          out_buffer(DECODER_BLOCK_SIZE)
+    {
+        setg(out_buffer.data(), out_buffer.data(), out_buffer.data());
+    }
+
+    virtual ~Decoder()
+    {
+    }
+
+    /** Gives the data read from the stream before the decoder was
+     * built, e.g. to guess the codec. */
+    void set_first_block(std::vector<char> & block)
+    {
+        std::size_t n = block.size();
+        in_buffer.swap(block);
+        in_buffer.resize(DECODER_BLOCK_SIZE);
+        in_begin = in_buffer.data();
+        in_end = in_begin + n;
+    }
+};
+
+
+#ifdef LIBCNF_HAVE_ZLIB
+/**
+ * Decompresses gzip data, which may be made of several members.
+ */
+class GzipDecoder : public Decoder
+{
+private:
+    z_stream z;
+
+    /** Is true once the last member was decompressed. */
+    bool finished;
+
+    std::size_t decode(char * out, std::size_t n)
+    {
+        while (!finished)
+        {
+            if (in_begin == in_end && !refill())
+                throw std::runtime_error("Truncated gzip data.");
+            // z.avail_in is an unsigned int.
+            z.next_in = (Bytef *)in_begin;
+            z.avail_in = std::min<unsigned long int>(in_end - in_begin, 1UL << 30);
+            z.next_out = (Bytef *)out;
+            z.avail_out = n;
+            int status = inflate(&z, Z_NO_FLUSH);
+            in_begin = (const char *)z.next_in;
+            std::size_t produced = (char *)z.next_out - out;
+            if (status == Z_STREAM_END)
+            {
+                // Another member may follow.
+                if (in_begin == in_end && !refill())
+                    finished = true;
+                else
+                    inflateReset(&z);
+            }
+            else if (status != Z_OK)
+                throw std::runtime_error("Corrupted gzip data.");
+            if (produced > 0)
+                return produced;
+        }
+        return 0;
+    }
+
+public:
+    GzipDecoder(const char * begin, const char * end, std::istream * source)
+        : Decoder(begin, end, source), finished(false)
+    {
+        memset(&z, 0, sizeof(z));
+        if (inflateInit2(&z, 15 + 16) != Z_OK)
+            throw std::runtime_error("Cannot initialize zlib.");
+    }
+
+    ~GzipDecoder()
+    {
+        inflateEnd(&z);
+    }
+};
+#endif
+
+
+#ifdef LIBCNF_HAVE_LZMA
+/**
+ * Decompresses xz data, which may be made of several streams.
+ */
+class XzDecoder : public Decoder
+{
+private:
+    lzma_stream z;
+
+    /** Is true once there is no compressed data left to read. */
+    bool no_more_input;
+
+    /** Is true once the last stream was decompressed. */
+    bool finished;
+
+    std::size_t decode(char * out, std::size_t n)
+    {
+        while (!finished)
+        {
+            if (in_begin == in_end && !no_more_input)
+                no_more_input = !refill();
+            z.next_in = (const uint8_t *)in_begin;
+            z.avail_in = in_end - in_begin;
+            z.next_out = (uint8_t *)out;
+            z.avail_out = n;
+            lzma_ret status = lzma_code(&z, no_more_input ? LZMA_FINISH : LZMA_RUN);
+            in_begin = (const char *)z.next_in;
+            std::size_t produced = (char *)z.next_out - out;
+            if (status == LZMA_STREAM_END)
+                finished = true;
+            else if (status != LZMA_OK)
+                throw std::runtime_error((status == LZMA_BUF_ERROR)
+                                         ? "Truncated xz data."
+                                         : "Corrupted xz data.");
+            if (produced > 0)
+                return produced;
+        }
+        return 0;
+    }
+
+public:
+    XzDecoder(const char * begin, const char * end, std::istream * source)
+        : Decoder(begin, end, source), no_more_input(false), finished(false)
+    {
+        z = LZMA_STREAM_INIT;
+        if (lzma_stream_decoder(&z, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+            throw std::runtime_error("Cannot initialize liblzma.");
+    }
+
+    ~XzDecoder()
+    {
+        lzma_end(&z);
+    }
+};
+#endif
+
+
+#ifdef LIBCNF_HAVE_ZSTD
+/**
+ * Decompresses zstd data, which may be made of several frames.
+ */
+class ZstdDecoder : public Decoder
+{
+private:
+    ZSTD_DCtx * z;
+
+    /** The last value returned by ZSTD_decompressStream(), which is
+     * 0 when a frame was entirely decompressed and returned. */
+    std::size_t status;
+
+    std::size_t decode(char * out, std::size_t n)
+    {
+        while (true)
+        {
+            ZSTD_outBuffer o = {out, n, 0};
+            if (in_begin == in_end && !refill())
+            {
+                if (status == 0)
+                    return 0;
+                // Flushes what the decoder still holds.
+                ZSTD_inBuffer i = {in_begin, 0, 0};
+                status = ZSTD_decompressStream(z, &o, &i);
+                if (ZSTD_isError(status) || o.pos == 0)
+                    throw std::runtime_error("Truncated zstd data.");
+                return o.pos;
+            }
+            ZSTD_inBuffer i = {in_begin, (std::size_t)(in_end - in_begin), 0};
+            status = ZSTD_decompressStream(z, &o, &i);
+            if (ZSTD_isError(status))
+                throw std::runtime_error("Corrupted zstd data.");
+            in_begin += i.pos;
+            if (o.pos > 0)
+                return o.pos;
+        }
+    }
+
+public:
+    ZstdDecoder(const char * begin, const char * end, std::istream * source)
+        : Decoder(begin, end, source), status(1)
+    {
+        z = ZSTD_createDCtx();
+    }
+
+    ~ZstdDecoder()
+    {
+        ZSTD_freeDCtx(z);
+    }
+};
+#endif
+
+
+/**
+ * Returns the data as it is.
+ */
+class PlainDecoder : public Decoder
+{
+private:
+    std::size_t decode(char * out, std::size_t n)
+    {
+        if (in_begin == in_end && !refill())
+            return 0;
+        n = std::min<std::size_t>(n, in_end - in_begin);
+        memcpy(out, in_begin, n);
+        in_begin += n;
+        return n;
+    }
+
+public:
+    PlainDecoder(const char * begin, const char * end, std::istream * source)
+        : Decoder(begin, end, source)
+    {
+    }
+
+    ~PlainDecoder()
+    {
+    }
+};
+
+
+/** Returns a decoder for the compressed data between `begin` and
+ * `end` followed by what is read from `source` (if not NULL), the
+ * codec being guessed from the first bytes. */
+static Decoder * new_decoder(const char * begin,
+                             const char * end,
+                             std::istream * source)
+{
+    Compression::Codec codec = Compression::of_content(begin, end);
+    check_available(codec);
+    switch (codec)
+    {
+#ifdef LIBCNF_HAVE_ZLIB
+    case Compression::GZIP:
+        return new GzipDecoder(begin, end, source);
+#endif
+#ifdef LIBCNF_HAVE_LZMA
+    case Compression::XZ:
+        return new XzDecoder(begin, end, source);
+#endif
+#ifdef LIBCNF_HAVE_ZSTD
+    case Compression::ZSTD:
+        return new ZstdDecoder(begin, end, source);
+#endif
+    default:
+        return new PlainDecoder(begin, end, source);
+    }
+}
+
+
+Compression::Input::Input(const char * begin, const char * end)
+    : std::istream(NULL), lines_cut(0), lines_filled(0)
+{
+    decoder.reset(new_decoder(begin, end, NULL));
+    rdbuf(decoder.get());
+    // The errors of the decoder are thrown instead of setting badbit.
+    exceptions(std::ios::badbit);
+}
+
+
+Compression::Input::Input(std::istream * input)
+    : std::istream(NULL), lines_cut(0), lines_filled(0)
+{
+    // The first block of the stream tells the codec.
+    std::vector<char> first(DECODER_BLOCK_SIZE);
+    input->read(first.data(), first.size());
+    first.resize(input->gcount());
+    Decoder * d = new_decoder(first.data(), first.data() + first.size(), input);
+    d->set_first_block(first);
+    decoder.reset(d);
+    rdbuf(decoder.get());
+    exceptions(std::ios::badbit);
+}
+
+
+Compression::Input::~Input()
+{
+}
+
+
+bool Compression::Input::read_lines(const char * & begin,
+                                    const char * & end,
+                                    std::size_t block_size)
+{
+    // What follows the last line returned is moved to the front.
+    lines_filled -= lines_cut;
+    memmove(lines.data(), lines.data() + lines_cut, lines_filled);
+    lines_cut = 0;
+    if (lines.size() < block_size)
+        lines.resize(block_size);
+    while (true)
+    {
+        read(lines.data() + lines_filled, lines.size() - lines_filled);
+        lines_filled += gcount();
+        if (lines_filled < lines.size())
+        {
+            // The end of the data.
+            lines_cut = lines_filled;
+            break;
+        }
+        std::size_t i = lines_filled;
+        while (i > 0 && lines[i-1] != '\n')
+            i--;
+        if (i > 0)
+        {
+            lines_cut = i;
+            break;
+        }
+        // A line longer than the buffer.
+        lines.resize(2*lines.size());
+    }
+    begin = lines.data();
+    end = begin + lines_cut;
+    return lines_cut > 0;
+}
+
+
+std::vector<char> Compression::decompress(const char * begin, const char * end)
+{
+    Input in(begin, end);
+    std::vector<char> result;
+    char block[1 << 16];
+    while (in.read(block, sizeof(block)) || in.gcount() > 0)
+        result.insert(result.end(), block, block + in.gcount());
+    return result;
+}
+
+
+// !SECTION! Compression
+// =====================
+
+/**
+ * A stream buffer giving its content to a codec by blocks of
+ * BLOCK_SIZE bytes and writing what it returns in a file.
+ */
+class Encoder : public std::streambuf
+{
+protected:
+    /** The file written. */
+    std::ofstream file;
+
+    /** The threads used by the codec. */
+    unsigned int n_threads;
+
+    /** The content not compressed yet. */
+    std::vector<char> pending;
+
+    /** Compresses the data between `begin` and `end` and writes it
+     * in the file; `last` is true if nothing comes after it. */
+    virtual void encode(const char * begin, const char * end, bool last) = 0;
+
+    /** Writes the compressed data between `begin` and `end`. */
+    void write(const char * begin, const char * end)
+    {
+        file.write(begin, end - begin);
+        if (!file)
+            throw std::runtime_error("Cannot write a compressed file.");
+    }
+
+    int overflow(int c)
+    {
+        encode(pbase(), pptr(), false);
+        setp(pending.data(), pending.data() + pending.size());
+        if (c != EOF)
+        {
+            *pptr() = c;
+            pbump(1);
+        }
+        return (c == EOF) ? 0 : c;
+    }
+
+public:
+    /** Is true once finish() was called. */
+    bool finished;
+
+    Encoder(const std::string & path, unsigned int _n_threads)
+        : file(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary),
+          n_threads(_n_threads),
+          pending(BLOCK_SIZE),
+          finished(false)
+    {
+        if (!file)
+            throw std::runtime_error("Cannot write " + path + ".");
+        setp(pending.data(), pending.data() + pending.size());
+    }
+
+    virtual ~Encoder()
+    {
+    }
+
+    /** Compresses what remains and closes the file. */
+    void finish()
+    {
+        finished = true;
+        encode(pbase(), pptr(), true);
+        setp(pending.data(), pending.data() + pending.size());
+        file.close();
+        if (file.fail())
+            throw std::runtime_error("Cannot write a compressed file.");
+    }
+};
+
+
+#ifdef LIBCNF_HAVE_ZLIB
+/**
+ * Writes each block as a separate gzip member, several of them being
+ * compressed at once by different threads.
+ */
+class GzipEncoder : public Encoder
+{
+private:
+    /** The blocks waiting for a thread. */
+    std::vector<std::vector<char> > blocks;
+
+    /** Returns the gzip member containing the given block. */
+    static std::vector<char> member(const std::vector<char> & block)
+    {
+        z_stream z;
+        memset(&z, 0, sizeof(z));
+        if (deflateInit2(&z, GZIP_LEVEL, Z_DEFLATED, 15 + 16, 8,
+                         Z_DEFAULT_STRATEGY) != Z_OK)
+            throw std::runtime_error("Cannot initialize zlib.");
+        std::vector<char> result(deflateBound(&z, block.size()));
+        z.next_in = (Bytef *)block.data();
+        z.avail_in = block.size();
+        z.next_out = (Bytef *)result.data();
+        z.avail_out = result.size();
+        int status = deflate(&z, Z_FINISH);
+        result.resize(z.total_out);
+        deflateEnd(&z);
+        if (status != Z_STREAM_END)
+            throw std::runtime_error("Cannot compress with zlib.");
+        return result;
+    }
+
+    void encode(const char * begin, const char * end, bool last)
+    {
+        if (begin != end || (last && blocks.empty()))
+            blocks.push_back(std::vector<char>(begin, end));
+        if (blocks.size() < n_threads && !last)
+            return;
+
+        std::vector<std::vector<char> > members(blocks.size());
+        std::atomic<unsigned int> next(0);
+        std::atomic<bool> failed(false);
+        std::vector<std::thread> threads;
+        for (unsigned int t=0; t<n_threads && t<blocks.size(); t++)
+            threads.push_back(std::thread([&]() {
+                        for (unsigned int i = next++; i < blocks.size(); i = next++)
+                            try
+                            {
+                                members[i] = member(blocks[i]);
+                            }
+                            catch (std::runtime_error &)
+                            {
+                                failed = true;
+                            }
+                    }));
+        for (unsigned int t=0; t<threads.size(); t++)
+            threads[t].join();
+        if (failed)
+            throw std::runtime_error("Cannot compress with zlib.");
+        for (unsigned int i=0; i<members.size(); i++)
+            write(members[i].data(), members[i].data() + members[i].size());
+        blocks.clear();
+    }
+
+public:
+    GzipEncoder(const std::string & path, unsigned int n_threads)
+        : Encoder(path, n_threads)
+    {
+    }
+
+    ~GzipEncoder()
+    {
+    }
+};
+#endif
+
+
+#ifdef LIBCNF_HAVE_LZMA
+/**
+ * Uses the multithreaded encoder of liblzma.
+ */
+class XzEncoder : public Encoder
+{
+private:
+    lzma_stream z;
+
+    void encode(const char * begin, const char * end, bool last)
+    {
+        char block[1 << 16];
+        z.next_in = (const uint8_t *)begin;
+        z.avail_in = end - begin;
+        lzma_ret status = LZMA_OK;
+        do
+        {
+            z.next_out = (uint8_t *)block;
+            z.avail_out = sizeof(block);
+            status = lzma_code(&z, last ? LZMA_FINISH : LZMA_RUN);
+            if (status != LZMA_OK && status != LZMA_STREAM_END)
+                throw std::runtime_error("Cannot compress with liblzma.");
+            write(block, (char *)z.next_out);
+        }
+        while (z.avail_in > 0 || (last && status != LZMA_STREAM_END));
+    }
+
+public:
+    XzEncoder(const std::string & path, unsigned int n_threads)
+        : Encoder(path, n_threads)
+    {
+        z = LZMA_STREAM_INIT;
+        lzma_ret status;
+        if (n_threads > 1)
+        {
+            lzma_mt options;
+            memset(&options, 0, sizeof(options));
+            options.threads = n_threads;
+            options.preset = XZ_PRESET;
+            options.check = LZMA_CHECK_CRC64;
+            status = lzma_stream_encoder_mt(&z, &options);
+        }
+        else
+            status = lzma_easy_encoder(&z, XZ_PRESET, LZMA_CHECK_CRC64);
+        if (status != LZMA_OK)
+            throw std::runtime_error("Cannot initialize liblzma.");
+    }
+
+    ~XzEncoder()
+    {
+        lzma_end(&z);
+    }
+};
+#endif
+
+
+#ifdef LIBCNF_HAVE_ZSTD
+/**
+ * Uses the multithreaded encoder of libzstd, if it was built with it.
+ */
+class ZstdEncoder : public Encoder
+{
+private:
+    ZSTD_CCtx * z;
+
+    void encode(const char * begin, const char * end, bool last)
+    {
+        char block[1 << 16];
+        ZSTD_inBuffer in = {begin, (std::size_t)(end - begin), 0};
+        std::size_t remaining;
+        do
+        {
+            ZSTD_outBuffer out = {block, sizeof(block), 0};
+            remaining = ZSTD_compressStream2(
+                z, &out, &in, last ? ZSTD_e_end : ZSTD_e_continue);
+            if (ZSTD_isError(remaining))
+                throw std::runtime_error("Cannot compress with libzstd.");
+            write(block, block + out.pos);
+        }
+        while (in.pos < in.size || (last && remaining != 0));
+    }
+
+public:
+    ZstdEncoder(const std::string & path, unsigned int n_threads)
+        : Encoder(path, n_threads)
+    {
+        z = ZSTD_createCCtx();
+        ZSTD_CCtx_setParameter(z, ZSTD_c_compressionLevel, ZSTD_LEVEL);
+        // Fails without effect if libzstd has no thread support.
+        if (n_threads > 1)
+            ZSTD_CCtx_setParameter(z, ZSTD_c_nbWorkers, n_threads);
+    }
+
+    ~ZstdEncoder()
+    {
+        ZSTD_freeCCtx(z);
+    }
+};
+#endif
+
+
+/**
+ * Writes the data as it is.
+ */
+class PlainEncoder : public Encoder
+{
+private:
+    void encode(const char * begin, const char * end, bool)
+    {
+        write(begin, end);
+    }
+
+public:
+    PlainEncoder(const std::string & path)
+        : Encoder(path, 1)
+    {
+    }
+
+    ~PlainEncoder()
+    {
+    }
+};
+
+
+Compression::Output::Output(const std::string & path,
+                            Codec codec,
+                            unsigned int n_threads)
+    : std::ostream(NULL)
+{
+    check_available(codec);
+    if (n_threads == 0)
+        n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+    switch (codec)
+    {
+#ifdef LIBCNF_HAVE_ZLIB
+    case GZIP:
+        encoder.reset(new GzipEncoder(path, n_threads));
+        break;
+#endif
+#ifdef LIBCNF_HAVE_LZMA
+    case XZ:
+        encoder.reset(new XzEncoder(path, n_threads));
+        break;
+#endif
+#ifdef LIBCNF_HAVE_ZSTD
+    case ZSTD:
+        encoder.reset(new ZstdEncoder(path, n_threads));
+        break;
+#endif
+    default:
+        encoder.reset(new PlainEncoder(path));
+    }
+    rdbuf(encoder.get());
+}
+
+
+Compression::Output::~Output()
+{
+    try
+    {
+        close();
+    }
+    catch (std::runtime_error &)
+    {
+    }
+}
+
+
+void Compression::Output::close()
+{
+    Encoder * e = static_cast<Encoder *>(encoder.get());
+    if (e->finished)
+        return;
+    try
+    {
+        e->finish();
+    }
+    catch (std::runtime_error &)
+    {
+        setstate(std::ios::badbit);
+        throw;
+    }
+}
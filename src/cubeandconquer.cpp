@@ -0,0 +1,225 @@
+/**
+ * @name cubeandconquer.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 16:05:31 leo>
+ *
+ * @brief Source code of the CubeAndConquer class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+// !SECTION! Setting up the search
+// ===============================
+
+CubeAndConquer::CubeAndConquer(Formula * _f)
+{
+    f = _f;
+    n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+    lookahead_depth = 0;
+    n_cubes = 0;
+    n_solved_cubes = 0;
+    n_steals = 0;
+}
+
+
+void CubeAndConquer::set_threads(unsigned int n)
+{
+    n_threads = (n > 0) ? n : 1;
+}
+
+
+void CubeAndConquer::set_split_variables(std::vector<long int> codes)
+{
+    split_codes = codes;
+}
+
+
+void CubeAndConquer::set_lookahead_depth(unsigned int depth)
+{
+    lookahead_depth = depth;
+}
+
+
+std::vector<long int> CubeAndConquer::lookahead_variables()
+{
+    VariableSet * v = f->variables();
+    unsigned int depth = lookahead_depth;
+    if (depth == 0)
+        while ((1UL << depth) < 16UL*n_threads)
+            depth ++;
+
+    // Only the variables appearing the most are probed.
+    std::vector<unsigned long int> occurrences(v->size()+1, 0);
+    for (unsigned long int i=0; i<f->size(); i++)
+        for (const Lit * l=f->clause_begin(i); l!=f->clause_end(i); l++)
+        {
+            unsigned long int x = v->new_code(*l).var().code();
+            if (x < occurrences.size())
+                occurrences[x] ++;
+        }
+    std::vector<long int> candidates;
+    for (unsigned long int x=1; x<occurrences.size(); x++)
+        if (occurrences[x] > 0)
+            candidates.push_back(x);
+    std::sort(candidates.begin(), candidates.end(),
+              [&occurrences](long int a, long int b) {
+                  return occurrences[a] > occurrences[b];
+              });
+    if (candidates.size() > std::max(64U, 4*depth))
+        candidates.resize(std::max(64U, 4*depth));
+
+    // The score of a variable is the product of the number of
+    // literals assigned by both of its values, as in march.
+    IncrementalSolver s(v);
+    s.add_formula(*f);
+    std::vector<std::pair<double, long int> > scores;
+    for (unsigned int i=0; i<candidates.size(); i++)
+    {
+        long int
+            pos = s.probe(candidates[i]),
+            neg = s.probe(no(candidates[i]));
+        if (pos >= 0 && neg >= 0)
+            scores.push_back(std::make_pair(-(double)(pos+1)*(neg+1),
+                                            candidates[i]));
+    }
+    std::sort(scores.begin(), scores.end());
+    std::vector<long int> result;
+    for (unsigned int i=0; i<scores.size() && i<depth; i++)
+        result.push_back(scores[i].second);
+    return result;
+}
+
+
+// !SECTION! Sharing the cubes
+// ===========================
+
+bool CubeAndConquer::pop(WorkQueue & q, unsigned long int & cube)
+{
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (q.ranges.empty())
+        return false;
+    std::pair<unsigned long int, unsigned long int> & r = q.ranges.back();
+    cube = r.first;
+    r.first ++;
+    if (r.first == r.second)
+        q.ranges.pop_back();
+    return true;
+}
+
+
+bool CubeAndConquer::steal(WorkQueue & victim, WorkQueue & thief)
+{
+    std::pair<unsigned long int, unsigned long int> taken;
+    {
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (victim.ranges.empty())
+            return false;
+        std::pair<unsigned long int, unsigned long int> & r
+            = victim.ranges.front();
+        if (r.second - r.first > 1)
+        {
+            unsigned long int middle = r.first + (r.second - r.first)/2;
+            taken = std::make_pair(middle, r.second);
+            r.second = middle;
+        }
+        else
+        {
+            taken = r;
+            victim.ranges.pop_front();
+        }
+    }
+    std::lock_guard<std::mutex> guard(thief.lock);
+    thief.ranges.push_back(taken);
+    return true;
+}
+
+
+// !SECTION! Solving the cubes
+// ===========================
+
+bool CubeAndConquer::run()
+{
+    VariableSet * v = f->variables();
+    std::vector<long int> split = split_codes;
+    if (split.empty())
+        split = lookahead_variables();
+    if (split.size() > 40)
+        throw std::domain_error("Too many variables to split on.");
+    n_cubes = 1UL << split.size();
+    n_steals = 0;
+
+    // Each thread starts with a contiguous block of cubes.
+    std::vector<WorkQueue> queues(n_threads);
+    for (unsigned int t=0; t<n_threads; t++)
+    {
+        unsigned long int
+            first = n_cubes * t / n_threads,
+            last = n_cubes * (t+1) / n_threads;
+        if (first < last)
+            queues[t].ranges.push_back(std::make_pair(first, last));
+    }
+
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned long int> solved(0), steals(0);
+    std::mutex model_lock;
+    bool found = false;
+    std::vector<std::thread> threads;
+    for (unsigned int t=0; t<n_threads; t++)
+        threads.push_back(std::thread([&, t]() {
+                    IncrementalSolver s(v);
+                    s.add_formula(*f);
+                    s.set_stop_flag(&stop);
+                    unsigned long int cube;
+                    while (!stop)
+                    {
+                        if (!pop(queues[t], cube))
+                        {
+                            bool stolen = false;
+                            for (unsigned int k=1; k<n_threads && !stolen; k++)
+                                stolen = steal(queues[(t+k) % n_threads],
+                                               queues[t]);
+                            if (!stolen)
+                                break;
+                            steals ++;
+                            continue;
+                        }
+                        std::vector<long int> assumed(split.size());
+                        for (unsigned int i=0; i<split.size(); i++)
+                            assumed[i] = ((cube >> i) & 1) ?
+                                split[i] : no(split[i]);
+                        if (s.solve(assumed))
+                        {
+                            std::lock_guard<std::mutex> guard(model_lock);
+                            if (!found)
+                            {
+                                found = true;
+                                s.store_model();
+                            }
+                            stop = true;
+                        }
+                        if (!s.interrupted())
+                            solved ++;
+                    }
+                }));
+    for (unsigned int t=0; t<n_threads; t++)
+        threads[t].join();
+
+    n_solved_cubes = solved;
+    n_steals = steals;
+    if (found)
+        f->extend_model();
+    return found;
+}
+
+
+void CubeAndConquer::print_statistics() const
+{
+    std::cout << "cubes: " << n_cubes << std::endl
+              << "solved cubes: " << n_solved_cubes << std::endl
+              << "steals: " << n_steals << std::endl;
+}
@@ -0,0 +1,184 @@
+/**
+ * @name decomposition.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 16:48:10 leo>
+ *
+ * @brief Source code of the Decomposition class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+/** Returns the representative of x in the union-find structure,
+ * halving the paths on the way. */
+static unsigned long int find_root(std::vector<unsigned long int> & parent,
+                                   unsigned long int x)
+{
+    while (parent[x] != x)
+    {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+
+// !SECTION! Finding the components
+// ================================
+
+Decomposition::Decomposition(Formula * _f)
+{
+    f = _f;
+    has_empty_clause = false;
+    n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+
+    VariableSet * v = f->variables();
+    unsigned long int max_code = v->size();
+    for (unsigned long int i=0; i<f->size(); i++)
+        for (const Lit * l=f->clause_begin(i); l!=f->clause_end(i); l++)
+        {
+            unsigned long int x = v->new_code(*l).var().code();
+            if (x > max_code)
+                max_code = x;
+        }
+
+    // Union by size of the variables of each clause.
+    std::vector<unsigned long int> parent(max_code+1), weight(max_code+1, 1);
+    for (unsigned long int x=0; x<=max_code; x++)
+        parent[x] = x;
+    for (unsigned long int i=0; i<f->size(); i++)
+    {
+        if (f->clause_begin(i) == f->clause_end(i))
+        {
+            has_empty_clause = true;
+            continue;
+        }
+        unsigned long int root = find_root(
+            parent, v->new_code(*f->clause_begin(i)).var().code());
+        for (const Lit * l=f->clause_begin(i)+1; l!=f->clause_end(i); l++)
+        {
+            unsigned long int other = find_root(parent, v->new_code(*l).var().code());
+            if (other == root)
+                continue;
+            if (weight[other] > weight[root])
+                std::swap(other, root);
+            parent[other] = root;
+            weight[root] += weight[other];
+        }
+    }
+
+    // Numbering the components and their variables.
+    std::vector<long int> component_of(max_code+1, -1), local(max_code+1, 0);
+    for (unsigned long int i=0; i<f->size(); i++)
+        for (const Lit * l=f->clause_begin(i); l!=f->clause_end(i); l++)
+        {
+            unsigned long int x = v->new_code(*l).var().code();
+            if (local[x] != 0)
+                continue;
+            unsigned long int root = find_root(parent, x);
+            if (component_of[root] < 0)
+            {
+                component_of[root] = components.size();
+                components.push_back(std::unique_ptr<Component>(new Component()));
+            }
+            Component & c = *components[component_of[root]];
+            c.codes.push_back(x);
+            local[x] = c.codes.size();
+        }
+    for (unsigned int k=0; k<components.size(); k++)
+        components[k]->variables.add_subset(
+            "x", {(unsigned int)components[k]->codes.size()});
+
+    for (unsigned long int i=0; i<f->size(); i++)
+    {
+        if (f->clause_begin(i) == f->clause_end(i))
+            continue;
+        Clause c;
+        long int root = -1;
+        for (const Lit * l=f->clause_begin(i); l!=f->clause_end(i); l++)
+        {
+            Lit x = v->new_code(*l);
+            if (root < 0)
+                root = find_root(parent, x.var().code());
+            long int y = local[x.var().code()];
+            c.push_back(x.is_negated() ? (-1)*y : y);
+        }
+        components[component_of[root]]->formula.add_clause(c);
+    }
+}
+
+
+unsigned int Decomposition::size() const
+{
+    return components.size();
+}
+
+
+const Formula & Decomposition::component(unsigned int i) const
+{
+    return components[i]->formula;
+}
+
+
+const std::vector<long int> & Decomposition::component_codes(unsigned int i) const
+{
+    return components[i]->codes;
+}
+
+
+// !SECTION! Solving the components
+// ================================
+
+void Decomposition::set_threads(unsigned int n)
+{
+    n_threads = (n > 0) ? n : 1;
+}
+
+
+bool Decomposition::solve()
+{
+    if (has_empty_clause)
+        return false;
+    VariableSet * v = f->variables();
+
+    // The components are variable-disjoint so that the threads never
+    // write the same entry of `values`.
+    std::vector<signed char> values(v->size()+1, -1);
+    std::atomic<unsigned int> next(0);
+    std::atomic<bool> unsat(false);
+    std::vector<std::thread> threads;
+    for (unsigned int t=0; t<n_threads && t<components.size(); t++)
+        threads.push_back(std::thread([&]() {
+                    for (unsigned int k=next++; k<components.size() && !unsat; k=next++)
+                    {
+                        Component & c = *components[k];
+                        IncrementalSolver s(&c.variables);
+                        s.set_stop_flag(&unsat);
+                        s.add_formula(c.formula);
+                        if (!s.solve())
+                        {
+                            unsat = true;
+                            break;
+                        }
+                        for (unsigned int i=0; i<c.codes.size(); i++)
+                            if ((unsigned long int)c.codes[i] < values.size())
+                                values[c.codes[i]] = s.model_value(i+1) ? 1 : -1;
+                    }
+                }));
+    for (unsigned int t=0; t<threads.size(); t++)
+        threads[t].join();
+    if (unsat)
+        return false;
+
+    v->clear_assignment();
+    for (unsigned long int x=1; x<values.size(); x++)
+        if (values[x] > 0)
+            v->set_literal(x);
+    v->propagate_equalities();
+    f->extend_model();
+    return true;
+}
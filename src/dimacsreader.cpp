@@ -0,0 +1,608 @@
+/**
+ * @name dimacsreader.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 22:03:16 leo>
+ *
+ * @brief Source code of the DimacsReader class.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+const unsigned int DimacsReader::MAX_XOR_SIZE;
+
+
+/** The smallest number of bytes given to a thread. */
+static const unsigned long int MIN_CHUNK_SIZE = 1 << 20;
+
+/** The number of bytes of decompressed text parsed at once. */
+static const unsigned long int BLOCK_SIZE = 1 << 26;
+
+
+// !SECTION! Parsing a chunk
+// =========================
+
+/** What was found in a chunk of a DIMACS file. */
+struct DimacsChunk
+{
+    /** The literals of the clauses, one after the other. The first
+     * ones may belong to a clause started in the previous chunk. */
+    std::vector<Lit> literals;
+
+    /** The position in `literals` following each 0. */
+    std::vector<unsigned long int> ends;
+
+    /** The literals of the XOR constraints and the position following
+     * each of them. */
+    std::vector<long int> xor_literals;
+    std::vector<unsigned long int> xor_ends;
+
+    /** The number of variables given by the header, if any. */
+    unsigned long int header_variables;
+
+    /** The largest variable found. */
+    unsigned long int max_variable;
+
+    /** Is true if a "%" line ends the formula in this chunk. */
+    bool stopped;
+
+    /** Describes the first error found, if any. */
+    std::string error;
+
+    DimacsChunk() : header_variables(0), max_variable(0), stopped(false) {}
+};
+
+
+/** Skips the spaces and tabulations starting at p. */
+static const char * skip_blanks(const char * p, const char * end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+
+/** Skips everything up to the next line. */
+static const char * skip_line(const char * p, const char * end)
+{
+    while (p < end && *p != '\n')
+        p++;
+    return (p < end) ? p + 1 : p;
+}
+
+
+/** Reads the integer starting at p, stores it in x and returns a
+ * pointer to the character following it, or NULL if there is no
+ * integer at p. */
+static const char * read_integer(const char * p, const char * end, long int & x)
+{
+    bool negative = false;
+    if (p < end && *p == '-')
+    {
+        negative = true;
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9')
+        return NULL;
+    unsigned long int result = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+    {
+        result = 10*result + (*p - '0');
+        p++;
+    }
+    x = negative ? (-1)*(long int)result : (long int)result;
+    return p;
+}
+
+
+/** Parses the text between p and end, which starts at the beginning
+ * of a line, into c. */
+static void parse_chunk(const char * p, const char * end, DimacsChunk * c)
+{
+    long int x;
+    while (p < end)
+    {
+        p = skip_blanks(p, end);
+        if (p == end)
+            break;
+        if (*p == '\n')
+            p++;
+        else if (*p == '-' || (*p >= '0' && *p <= '9'))
+        {
+            p = read_integer(p, end, x);
+            if (p == NULL)
+            {
+                c->error = "a lonely '-'";
+                return;
+            }
+            if (x == 0)
+                c->ends.push_back(c->literals.size());
+            else if (x > Var::MAX_CODE || x < -(long int)Var::MAX_CODE)
+            {
+                c->error = "a variable too large";
+                return;
+            }
+            else
+            {
+                c->literals.push_back(Lit(x));
+                c->max_variable = std::max<unsigned long int>(
+                    c->max_variable, (x > 0) ? x : (-1)*x);
+            }
+        }
+        else if (*p == 'c')
+            p = skip_line(p, end);
+        else if (*p == 'p')
+        {
+            const char * q = skip_blanks(p + 1, end);
+            if (end - q < 3 || std::strncmp(q, "cnf", 3) != 0)
+            {
+                c->error = "a header which is not 'p cnf'";
+                return;
+            }
+            q = read_integer(skip_blanks(q + 3, end), end, x);
+            if (q == NULL || x < 0)
+            {
+                c->error = "a header without a number of variables";
+                return;
+            }
+            c->header_variables = x;
+            p = skip_line(q, end);
+        }
+        else if (*p == 'x')
+        {
+            // An XOR constraint, which must end on this line.
+            p++;
+            while (true)
+            {
+                p = skip_blanks(p, end);
+                p = (p == end) ? NULL : read_integer(p, end, x);
+                if (p == NULL)
+                {
+                    c->error = "an XOR constraint not ended by 0 on its line";
+                    return;
+                }
+                if (x == 0)
+                    break;
+                c->xor_literals.push_back(x);
+                c->max_variable = std::max<unsigned long int>(
+                    c->max_variable, (x > 0) ? x : (-1)*x);
+            }
+            c->xor_ends.push_back(c->xor_literals.size());
+        }
+        else if (*p == '%')
+        {
+            c->stopped = true;
+            return;
+        }
+        else
+        {
+            c->error = std::string("the unexpected character '") + *p + "'";
+            return;
+        }
+    }
+}
+
+
+// !SECTION! Encoding the XOR constraints
+// ======================================
+
+/** Returns the number of new variables needed to encode an XOR
+ * constraint with n literals. */
+static unsigned long int xor_extra_variables(unsigned long int n)
+{
+    unsigned long int extra = 0;
+    while (n > DimacsReader::MAX_XOR_SIZE)
+    {
+        n -= DimacsReader::MAX_XOR_SIZE - 2;
+        extra ++;
+    }
+    return extra;
+}
+
+
+/** Adds to f the clauses forbidding the assignments of the variables
+ * in `vars` whose xor is not `rhs`. */
+static void add_short_xor(Formula * f, const std::vector<long int> & vars, bool rhs)
+{
+    for (unsigned long int mask=0; mask < (1UL << vars.size()); mask++)
+    {
+        bool parity = false;
+        for (unsigned int j=0; j<vars.size(); j++)
+            parity ^= (mask >> j) & 1;
+        if (parity == rhs)
+            continue;
+        Clause c;
+        for (unsigned int j=0; j<vars.size(); j++)
+            c.push_back(((mask >> j) & 1) ? no(vars[j]) : vars[j]);
+        f->add_clause(c);
+    }
+}
+
+
+/** Adds to f the clauses encoding that the xor of the given literals
+ * is true. The new variables are taken in `extra` starting at
+ * `next_extra`. */
+static void add_xor_constraint(Formula * f,
+                               const long int * begin,
+                               const long int * end,
+                               const Subset & extra,
+                               unsigned long int & next_extra)
+{
+    LIBCNF_SOURCE(XOR);
+    bool rhs = true;
+    std::vector<long int> vars;
+    for (const long int * l = begin; l != end; l++)
+    {
+        rhs ^= (*l < 0);
+        vars.push_back((*l > 0) ? *l : (-1)*(*l));
+    }
+    // A variable appearing twice cancels out.
+    std::sort(vars.begin(), vars.end());
+    std::vector<long int> distinct;
+    for (unsigned int i=0; i<vars.size(); i++)
+        if (i+1 < vars.size() && vars[i] == vars[i+1])
+            i++;
+        else
+            distinct.push_back(vars[i]);
+
+    if (distinct.empty())
+    {
+        if (rhs)
+            f->add_clause(Clause());
+        return;
+    }
+    // The first literals are replaced by a new variable equal to
+    // their xor until the constraint is short enough.
+    while (distinct.size() > DimacsReader::MAX_XOR_SIZE)
+    {
+        long int t = extra(next_extra++);
+        std::vector<long int> piece(distinct.begin(),
+                                    distinct.begin() + DimacsReader::MAX_XOR_SIZE - 1);
+        piece.push_back(t);
+        add_short_xor(f, piece, false);
+        distinct.erase(distinct.begin(),
+                       distinct.begin() + DimacsReader::MAX_XOR_SIZE - 1);
+        distinct.insert(distinct.begin(), t);
+    }
+    add_short_xor(f, distinct, rhs);
+}
+
+
+// !SECTION! Reading a formula
+// ===========================
+
+DimacsReader::DimacsReader()
+{
+    n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+    n_clauses = 0;
+    n_xors = 0;
+    n_variables = 0;
+}
+
+
+void DimacsReader::set_threads(unsigned int n)
+{
+    n_threads = (n > 0) ? n : 1;
+}
+
+
+/** Returns a name which is not used by a subset of v, starting with
+ * `base`. */
+static std::string unused_subset_name(VariableSet * v, const std::string & base)
+{
+    std::string name = base;
+    for (unsigned int i=2; ; i++)
+    {
+        try
+        {
+            v->subset(name);
+        }
+        catch (std::domain_error &)
+        {
+            return name;
+        }
+        std::stringstream s;
+        s << base << "_" << i;
+        name = s.str();
+    }
+}
+
+
+/** What is carried from a block of the text to the next one. */
+struct DimacsReader::Progress
+{
+    /** Used in the error messages. */
+    std::string path;
+
+    /** The literals read after the last 0 when the clauses are added
+     * one after the other. In the arena, they are after the last
+     * clause of the formula instead. */
+    Clause pending;
+
+    /** The number of variables given by the header, the largest
+     * variable found and the number of variables needed to encode
+     * the long XOR constraints. */
+    unsigned long int header_variables, max_variable, n_extra;
+
+    /** The XOR constraints, which are added at the end. */
+    std::vector<long int> xor_literals;
+    std::vector<unsigned long int> xor_ends;
+
+    /** Is true once a "%" line was found. */
+    bool stopped;
+
+    Progress(const std::string & _path)
+        : path(_path), header_variables(0), max_variable(0), n_extra(0), stopped(false)
+    {
+    }
+};
+
+
+void DimacsReader::read_block(const char * begin,
+                              const char * end,
+                              Formula * f,
+                              Progress & progress)
+{
+    // The text is cut at line boundaries.
+    unsigned long int size = end - begin;
+    unsigned int n_chunks = std::min<unsigned long int>(
+        n_threads, size / MIN_CHUNK_SIZE + 1);
+    std::vector<const char *> bounds(n_chunks + 1, end);
+    bounds[0] = begin;
+    for (unsigned int i=1; i<n_chunks; i++)
+    {
+        const char * p = std::max(bounds[i-1], begin + (size / n_chunks) * i);
+        while (p < end && p > begin && *(p - 1) != '\n')
+            p++;
+        bounds[i] = p;
+    }
+
+    std::vector<DimacsChunk> chunks(n_chunks);
+    std::vector<std::thread> threads;
+    for (unsigned int i=0; i<n_chunks; i++)
+        threads.push_back(std::thread(parse_chunk, bounds[i], bounds[i+1], &chunks[i]));
+    for (unsigned int i=0; i<n_chunks; i++)
+        threads[i].join();
+    for (unsigned int i=0; i<n_chunks; i++)
+    {
+        if (!chunks[i].error.empty())
+            throw std::runtime_error(progress.path + " contains " + chunks[i].error + ".");
+        if (chunks[i].stopped)
+        {
+            chunks.resize(i + 1);
+            progress.stopped = true;
+            break;
+        }
+    }
+
+    for (unsigned int i=0; i<chunks.size(); i++)
+    {
+        n_clauses += chunks[i].ends.size();
+        n_xors += chunks[i].xor_ends.size();
+        progress.header_variables = std::max(progress.header_variables,
+                                             chunks[i].header_variables);
+        progress.max_variable = std::max(progress.max_variable,
+                                         chunks[i].max_variable);
+        unsigned long int offset = progress.xor_literals.size();
+        for (unsigned long int k=0; k<chunks[i].xor_ends.size(); k++)
+        {
+            progress.n_extra += xor_extra_variables(
+                chunks[i].xor_ends[k] - ((k > 0) ? chunks[i].xor_ends[k-1] : 0));
+            progress.xor_ends.push_back(offset + chunks[i].xor_ends[k]);
+        }
+        progress.xor_literals.insert(progress.xor_literals.end(),
+                                     chunks[i].xor_literals.begin(),
+                                     chunks[i].xor_literals.end());
+    }
+
+    if (f->normalizing || f->stream)
+    {
+        // The clauses have to be looked for in the index, or written
+        // in the stream, one after the other.
+        Clause & c = progress.pending;
+        for (unsigned int i=0; i<chunks.size(); i++)
+        {
+            unsigned long int k = 0;
+            for (unsigned long int e=0; e<chunks[i].ends.size(); e++)
+            {
+                for (; k<chunks[i].ends[e]; k++)
+                    c.push_back(chunks[i].literals[k].code());
+                f->add_clause(c);
+                c = Clause();
+            }
+            for (; k<chunks[i].literals.size(); k++)
+                c.push_back(chunks[i].literals[k].code());
+        }
+    }
+    else
+    {
+        // The literals of the chunks are concatenated in the arena so
+        // that a clause spanning two chunks, or two blocks, is in one
+        // piece.
+        std::vector<unsigned long int>
+            literal_offsets(chunks.size() + 1, f->literals.size()),
+            clause_offsets(chunks.size() + 1, f->clause_starts.size());
+        for (unsigned int i=0; i<chunks.size(); i++)
+        {
+            literal_offsets[i+1] = literal_offsets[i] + chunks[i].literals.size();
+            clause_offsets[i+1] = clause_offsets[i] + chunks[i].ends.size();
+        }
+        f->literals.resize(literal_offsets.back());
+        f->clause_starts.resize(clause_offsets.back());
+        for (unsigned int i=0; i<chunks.size(); i++)
+            threads[i] = std::thread([&, i]() {
+                    std::copy(chunks[i].literals.begin(),
+                              chunks[i].literals.end(),
+                              f->literals.begin() + literal_offsets[i]);
+                    for (unsigned long int e=0; e<chunks[i].ends.size(); e++)
+                        f->clause_starts[clause_offsets[i] + e] =
+                            literal_offsets[i] + chunks[i].ends[e];
+                    std::vector<Lit>().swap(chunks[i].literals);
+                });
+        for (unsigned int i=0; i<chunks.size(); i++)
+            threads[i].join();
+        for (unsigned long int i=clause_offsets[0]; i<f->clause_starts.size(); i++)
+            LIBCNF_COUNT_CLAUSE(f->clause_starts[i] - f->clause_starts[i-1]);
+    }
+}
+
+
+void DimacsReader::finish(Formula * f, Progress & progress)
+{
+    // The last clause may lack its 0.
+    if (f->normalizing || f->stream)
+    {
+        if (progress.pending.size() > 0)
+        {
+            f->add_clause(progress.pending);
+            n_clauses ++;
+        }
+    }
+    else
+    {
+        if (f->literals.size() > f->clause_starts.back())
+        {
+            f->clause_starts.push_back(f->literals.size());
+            LIBCNF_COUNT_CLAUSE(f->clause_starts.back()
+                                - f->clause_starts[f->clause_starts.size() - 2]);
+            n_clauses ++;
+        }
+        LIBCNF_MEMORY(FORMULA, f->memory_usage());
+    }
+
+    // The variables of the file must exist in the VariableSet.
+    VariableSet * v = f->variables();
+    n_variables = std::max(progress.header_variables, progress.max_variable);
+    if (v->size() < n_variables)
+        v->add_subset(unused_subset_name(v, "dimacs"),
+                      {(unsigned int)(n_variables - v->size())});
+    Subset extra;
+    if (progress.n_extra > 0)
+        extra = v->add_subset(unused_subset_name(v, "dimacs_xor"),
+                              {(unsigned int)progress.n_extra});
+
+    unsigned long int next_extra = 0;
+    const long int * first = progress.xor_literals.data();
+    for (unsigned long int k=0; k<progress.xor_ends.size(); k++)
+        add_xor_constraint(
+            f,
+            first + ((k > 0) ? progress.xor_ends[k-1] : 0),
+            first + progress.xor_ends[k],
+            extra,
+            next_extra);
+}
+
+
+void DimacsReader::read(const char * begin,
+                        const char * end,
+                        Formula * f,
+                        const std::string & path)
+{
+    n_clauses = 0;
+    n_xors = 0;
+    n_variables = 0;
+    Progress progress(path);
+    read_block(begin, end, f, progress);
+    finish(f, progress);
+}
+
+
+void DimacsReader::read_input(Compression::Input * input,
+                              Formula * f,
+                              const std::string & path)
+{
+    n_clauses = 0;
+    n_xors = 0;
+    n_variables = 0;
+    Progress progress(path);
+    const char * begin, * end;
+    try
+    {
+        while (!progress.stopped && input->read_lines(begin, end, BLOCK_SIZE))
+            read_block(begin, end, f, progress);
+    }
+    catch (...)
+    {
+        // Drops the literals of an unfinished clause.
+        f->literals.resize(f->clause_starts.back());
+        throw;
+    }
+    finish(f, progress);
+}
+
+
+void DimacsReader::read_file(const std::string & path, Formula * f)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Cannot open " + path + ".");
+    struct stat status;
+    if (fstat(fd, &status) == -1)
+    {
+        close(fd);
+        throw std::runtime_error("Cannot read " + path + ".");
+    }
+    if (status.st_size == 0)
+    {
+        close(fd);
+        read(NULL, NULL, f, path);
+        return;
+    }
+    void * data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw std::runtime_error("Cannot map " + path + " in memory.");
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+    const char * begin = static_cast<const char *>(data);
+    try
+    {
+        if (Compression::of_content(begin, begin + status.st_size)
+            == Compression::NONE)
+            read(begin, begin + status.st_size, f, path);
+        else
+        {
+            Compression::Input input(begin, begin + status.st_size);
+            read_input(&input, f, path);
+        }
+    }
+    catch (...)
+    {
+        munmap(data, status.st_size);
+        throw;
+    }
+    munmap(data, status.st_size);
+}
+
+
+void DimacsReader::read_stream(std::istream * input, Formula * f)
+{
+    Compression::Input decompressed(input);
+    read_input(&decompressed, f, "The stream");
+}
+
+
+unsigned long int DimacsReader::clauses_read() const
+{
+    return n_clauses;
+}
+
+
+unsigned long int DimacsReader::xors_read() const
+{
+    return n_xors;
+}
+
+
+unsigned long int DimacsReader::variables_read() const
+{
+    return n_variables;
+}
@@ -0,0 +1,95 @@
+/**
+ * @name enumerator.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 14:40:12 leo>
+ *
+ * @brief Source code of the Enumerator class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+Enumerator::Enumerator(Formula * _f) :
+    f(_f),
+    solver(_f->variables()),
+    limit(0),
+    minimal_blocking(false)
+{
+    solver.add_formula(*f);
+}
+
+
+void Enumerator::set_projection(std::vector<long int> codes)
+{
+    projection = codes;
+}
+
+
+void Enumerator::set_limit(unsigned long int n)
+{
+    limit = n;
+}
+
+
+void Enumerator::set_minimal_blocking(bool enable)
+{
+    minimal_blocking = enable;
+}
+
+
+unsigned long int Enumerator::run(std::function<bool(VariableSet *)> callback)
+{
+    VariableSet * v = f->variables();
+    std::vector<long int> codes(projection);
+    if (codes.empty())
+        for (unsigned long int x=1; x<=v->size(); x++)
+            codes.push_back(x);
+
+    // The decisions made on the projection variables are identified
+    // by the variable they are renamed into.
+    std::unordered_set<long int> projected;
+    if (minimal_blocking)
+    {
+        solver.set_priority(codes);
+        for (unsigned int i=0; i<codes.size(); i++)
+        {
+            long int x = v->new_code(codes[i]);
+            projected.insert((x > 0) ? x : (-1)*x);
+        }
+    }
+    else
+        solver.set_priority(std::vector<long int>());
+
+    unsigned long int n_solutions = 0;
+    bool go_on = true;
+    while (go_on && (limit == 0 || n_solutions < limit) && solver.solve())
+    {
+        n_solutions ++;
+        Clause blocking;
+        if (minimal_blocking)
+        {
+            std::vector<long int> decisions = solver.model_decision_literals();
+            for (unsigned int i=0; i<decisions.size(); i++)
+                if (projected.count((decisions[i] > 0) ?
+                                    decisions[i] : (-1)*decisions[i]))
+                    blocking.push_back(no(decisions[i]));
+        }
+        else
+            for (unsigned int i=0; i<codes.size(); i++)
+                blocking.push_back(solver.model_value(codes[i]) ?
+                                   no(codes[i]) : codes[i]);
+        solver.store_model();
+        f->extend_model();
+        go_on = callback(v);
+        solver.add_clause(blocking);
+    }
+    return n_solutions;
+}
+
+
+IncrementalSolver & Enumerator::incremental_solver()
+{
+    return solver;
+}
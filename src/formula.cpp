@@ -6,6 +6,8 @@
  * @brief Source code of the Formula class.
  */
 
+#include <sys/stat.h>
+
 #include "../include/libcnf.hpp"
 
 using namespace cnf;
@@ -13,30 +15,289 @@ using namespace cnf;
 Formula::Formula(VariableSet * _v)
 {
     v = _v;
+    n_segment_clauses = 0;
+    deferring_equalities = false;
+    last_export.n_clauses = 0;
+    last_export.reused = 0;
+    last_export.fingerprint = 0;
+    normalizing = false;
+    counters.duplicate_literals = 0;
+    counters.tautologies = 0;
+    counters.duplicate_clauses = 0;
+    clause_starts.push_back(0);
+}
+
+
+// !SECTION! Storing the clauses
+// =============================
+
+void Formula::set_normalization(bool enable)
+{
+    normalizing = enable;
+    if (normalizing)
+    {
+        LIBCNF_SOURCE(INTERNAL);
+        std::vector<Clause> old_clauses;
+        for (unsigned long int i=0; i<size(); i++)
+            old_clauses.push_back(clause(i));
+        std::vector<Lit> old_literals;
+        std::vector<unsigned long int> old_starts;
+        clear(old_literals, old_starts);
+        for (unsigned long int i=0; i<old_clauses.size(); i++)
+            add_clause(old_clauses[i]);
+    }
+    else
+        clause_index.clear();
+}
+
+
+NormalizationCounters Formula::normalization_counters() const
+{
+    return counters;
+}
+
+
+void Formula::clear(std::vector<Lit> & old_literals,
+                    std::vector<unsigned long int> & old_starts)
+{
+    old_literals.swap(literals);
+    old_starts.swap(clause_starts);
+    literals.clear();
+    clause_starts.assign(1, 0);
+    clause_index.clear();
+    segments.clear();
+    n_segment_clauses = 0;
+    last_export.path.clear();
+}
+
+
+void Formula::add_segment(const Lit * lits,
+                          const unsigned long int * starts,
+                          unsigned long int n_clauses,
+                          std::shared_ptr<const void> owner)
+{
+    if (!literals.empty() || clause_starts.size() > 1)
+        throw std::logic_error(
+            "Segments must be added to a formula before its arena.");
+    ClauseSegment s;
+    s.literals = lits;
+    s.starts = starts;
+    s.n_clauses = n_clauses;
+    s.first_clause = n_segment_clauses;
+    s.owner = owner;
+    segments.push_back(s);
+    n_segment_clauses += n_clauses;
+    if (normalizing)
+        for (unsigned long int i=s.first_clause; i<n_segment_clauses; i++)
+            clause_index.insert(std::make_pair(clause_hash(i), i));
+}
+
+
+/** The clauses of an arena frozen by Formula::freeze(). */
+struct FrozenArena
+{
+    std::vector<Lit> literals;
+    std::vector<unsigned long int> starts;
+};
+
+
+void Formula::freeze()
+{
+    if (clause_starts.size() == 1)
+        return;
+    std::shared_ptr<FrozenArena> frozen = std::make_shared<FrozenArena>();
+    frozen->literals.swap(literals);
+    frozen->starts.swap(clause_starts);
+    frozen->literals.shrink_to_fit();
+    clause_starts.assign(1, 0);
+
+    // The clause indices do not change so clause_index is still
+    // valid.
+    ClauseSegment s;
+    s.literals = frozen->literals.data();
+    s.starts = frozen->starts.data();
+    s.n_clauses = frozen->starts.size() - 1;
+    s.first_clause = n_segment_clauses;
+    s.owner = frozen;
+    segments.push_back(s);
+    n_segment_clauses += s.n_clauses;
+}
+
+
+Formula Formula::variant() const
+{
+    return *this;
+}
+
+
+unsigned long int Formula::n_frozen_clauses() const
+{
+    return n_segment_clauses;
+}
+
+
+std::size_t Formula::clause_hash(unsigned long int i) const
+{
+    const Lit
+        * begin = clause_begin(i),
+        * end = clause_end(i);
+    std::size_t h = end - begin;
+    for (const Lit * l = begin; l != end; l++)
+        h ^= std::hash<uint32_t>()(l->index())
+            + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+    return h;
+}
+
+
+bool Formula::same_clauses(unsigned long int i, unsigned long int j) const
+{
+    if (clause_end(i) - clause_begin(i) != clause_end(j) - clause_begin(j))
+        return false;
+    return std::equal(clause_begin(i), clause_end(i), clause_begin(j));
 }
 
 
 void Formula::add_clause(Clause new_clause)
 {
-    clauses.push_back(new_clause);
+    if (normalizing)
+    {
+        unsigned int before = new_clause.size();
+        bool tautology = !new_clause.normalize();
+        counters.duplicate_literals += before - new_clause.size();
+        if (tautology)
+        {
+            counters.tautologies ++;
+            return;
+        }
+    }
+    if (stream)
+    {
+        write_to_stream(new_clause);
+        LIBCNF_COUNT_CLAUSE(new_clause.size());
+        return;
+    }
+    for (unsigned int j=0; j<new_clause.size(); j++)
+        literals.push_back(Lit(new_clause[j]));
+    clause_starts.push_back(literals.size());
+
+    if (normalizing)
+    {
+        // The clause is appended before being looked for in the index
+        // so that it can be compared with the others in place.
+        unsigned long int i = size() - 1;
+        std::size_t h = clause_hash(i);
+        auto range = clause_index.equal_range(h);
+        for (auto it = range.first; it != range.second; it++)
+            if (same_clauses(it->second, i))
+            {
+                clause_starts.pop_back();
+                literals.resize(clause_starts.back());
+                counters.duplicate_clauses ++;
+                return;
+            }
+        clause_index.insert(std::make_pair(h, i));
+    }
+    LIBCNF_COUNT_CLAUSE(new_clause.size());
+    LIBCNF_MEMORY(FORMULA, memory_usage());
 }
 
 
 void Formula::add_clauses(std::initializer_list<Clause> new_clauses)
 {
-    unsigned int i = 0, start = clauses.size();
-    clauses.resize(start + new_clauses.size());
     for (auto c = new_clauses.begin(); c != new_clauses.end(); c++)
+        add_clause(*c);
+}
+
+
+unsigned long int Formula::size() const
+{
+    return n_segment_clauses + clause_starts.size() - 1;
+}
+
+
+unsigned long int Formula::memory_usage() const
+{
+    return literals.capacity()*sizeof(Lit)
+        + clause_starts.capacity()*sizeof(unsigned long int)
+        + clause_index.bucket_count()*sizeof(void *)
+        + clause_index.size()*(sizeof(std::pair<std::size_t, unsigned long int>)
+                               + 2*sizeof(void *))
+        + reconstruction_stack.capacity()*sizeof(Clause)
+        + segments.capacity()*sizeof(ClauseSegment)
+        + deferred_equalities.capacity()*sizeof(long int);
+}
+
+
+VariableSet * Formula::variables() const
+{
+    return v;
+}
+
+
+Clause Formula::clause(unsigned long int i) const
+{
+    std::vector<long int> c;
+    c.reserve(clause_end(i) - clause_begin(i));
+    for (const Lit * l = clause_begin(i); l != clause_end(i); l++)
+        c.push_back(l->code());
+    return Clause(c);
+}
+
+
+const Formula::ClauseSegment & Formula::segment_of(unsigned long int i) const
+{
+    if (segments.size() == 1)
+        return segments[0];
+    // The segment chain may be long for a variant of a variant of
+    // ... so it is searched by dichotomy.
+    unsigned long int low = 0, high = segments.size() - 1;
+    while (low < high)
     {
-        clauses[start + i] = *c;
-        i++;
+        unsigned long int middle = (low + high + 1) / 2;
+        if (segments[middle].first_clause <= i)
+            low = middle;
+        else
+            high = middle - 1;
     }
+    return segments[low];
 }
 
 
-void Formula::add_var_equality(long int v1, long int v2)
+const Lit * Formula::clause_begin(unsigned long int i) const
 {
+    if (i >= n_segment_clauses)
+        return literals.data() + clause_starts[i - n_segment_clauses];
+    const ClauseSegment & s = segment_of(i);
+    return s.literals + s.starts[i - s.first_clause];
+}
+
+
+const Lit * Formula::clause_end(unsigned long int i) const
+{
+    if (i >= n_segment_clauses)
+        return literals.data() + clause_starts[i - n_segment_clauses + 1];
+    const ClauseSegment & s = segment_of(i);
+    return s.literals + s.starts[i - s.first_clause + 1];
+}
+
+
+// !SECTION! Adding constraints
+// ============================
 
+void Formula::add_var_equality(long int v1, long int v2)
+{
+    if (stream)
+    {
+        // The clauses already written cannot be renamed.
+        add_var_equality_clauses(v1, v2);
+        return;
+    }
+    if (deferring_equalities)
+    {
+        deferred_equalities.push_back(v1);
+        deferred_equalities.push_back(v2);
+        return;
+    }
     v->add_var_equality(v1, v2);
 
     // add_var_equality_clauses(v1, v2);
@@ -46,6 +307,7 @@ void Formula::add_var_equality(long int v1, long int v2)
 
 void Formula::add_var_equality_clauses(long int v1, long int v2)
 {
+    LIBCNF_SOURCE(EQUALITY);
     add_clauses({
             Clause{v1, no(v2)},
             Clause{no(v1), v2}});
@@ -54,6 +316,7 @@ void Formula::add_var_equality_clauses(long int v1, long int v2)
 
 void Formula::add_xor(long int v1, long int v2, long int v3)
 {
+    LIBCNF_SOURCE(XOR);
     add_clauses({
             Clause{no(v1), v2, v3},
             Clause{v1, no(v2), v3},
@@ -112,18 +375,485 @@ void Formula::add_xor_with_cstte(
 }
 
 
+// !SECTION! Exporting the formula
+// ================================
+
 void Formula::to_dimacs(
     std::ostream * out,
     unsigned int card_variables)
 {
+    LIBCNF_TIMER(EXPORT);
     (*out) << "p cnf " << card_variables
-           << " " << clauses.size()
+           << " " << size()
+           << "\n";
+    for (unsigned long int i=0; i<size(); i++)
+    {
+        for (const Lit * l = clause_begin(i); l != clause_end(i); l++)
+            (*out) << v->new_code(*l).code() << " ";
+        (*out) << "0\n";
+    }
+    out->flush();
+}
+
+
+DimacsNumbering Formula::to_dimacs(std::ostream * out)
+{
+    LIBCNF_TIMER(EXPORT);
+    // dense[x] is the number given to the variable with code x, 0 if
+    // it has not been seen yet.
+    std::vector<long int> dense(v->size() + 1, 0), codes;
+    for (unsigned long int i=0; i<size(); i++)
+        for (const Lit * l = clause_begin(i); l != clause_end(i); l++)
+        {
+            unsigned long int x = v->new_code(*l).var().code();
+            if (x >= dense.size())
+                dense.resize(x + 1, 0);
+            if (dense[x] == 0)
+            {
+                codes.push_back(x);
+                dense[x] = codes.size();
+            }
+        }
+
+    (*out) << "p cnf " << codes.size()
+           << " " << size()
            << "\n";
-    for (unsigned int i=0; i<clauses.size(); i++)
+    for (unsigned long int i=0; i<size(); i++)
     {
-        for (unsigned int j=0; j<clauses[i].size(); j++)
-            (*out) << v->new_code(clauses[i][j]) << " ";
+        for (const Lit * l = clause_begin(i); l != clause_end(i); l++)
+        {
+            Lit lit = v->new_code(*l);
+            long int x = dense[lit.var().code()];
+            (*out) << (lit.is_negated() ? (-1)*x : x) << " ";
+        }
         (*out) << "0\n";
     }
     out->flush();
+    return DimacsNumbering(codes);
+}
+
+
+/** The width of the numbers of the header written by
+ * Formula::to_dimacs_file(), enough for any 64-bit number. */
+static const int HEADER_WIDTH = 20;
+
+
+/** Writes the padded header of a DIMACS file. */
+static void write_padded_header(std::ostream * out,
+                                unsigned long int n_variables,
+                                unsigned long int n_clauses)
+{
+    (*out) << "p cnf " << std::setw(HEADER_WIDTH) << n_variables
+           << " " << std::setw(HEADER_WIDTH) << n_clauses << "\n";
+}
+
+
+/** The beginning of the first line of a file written by
+ * Formula::to_dimacs_file(), followed by the fingerprint of its
+ * clauses on 16 hexadecimal digits. */
+static const std::string EXPORT_MARKER = "c libcnf export ";
+
+
+/** Returns the first line of a file written by
+ * Formula::to_dimacs_file() whose clauses have the given
+ * fingerprint. */
+static std::string export_marker(uint64_t fingerprint)
+{
+    std::stringstream marker;
+    marker << EXPORT_MARKER << std::hex << std::setw(16) << std::setfill('0')
+           << fingerprint;
+    return marker.str();
+}
+
+
+/** Returns true if the first line of the file with the given path is
+ * the marker of the given fingerprint. */
+static bool has_marker(const std::string & path, uint64_t fingerprint)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    std::string line;
+    return std::getline(in, line) && line == export_marker(fingerprint);
+}
+
+
+/** Gets the size, the modification time and the inode of a file;
+ * returns false if it does not exist. */
+static bool file_status(const std::string & path,
+                        unsigned long int & size,
+                        unsigned long int & mtime,
+                        unsigned long int & inode)
+{
+    struct stat status;
+    if (stat(path.c_str(), &status) == -1)
+        return false;
+    size = status.st_size;
+    mtime = status.st_mtim.tv_sec * 1000000000UL + status.st_mtim.tv_nsec;
+    inode = status.st_ino;
+    return true;
+}
+
+
+DimacsNumbering Formula::to_dimacs_file(const std::string & path)
+{
+    LIBCNF_TIMER(EXPORT);
+    // The header of a compressed file cannot be rewritten in place.
+    Compression::Codec codec = Compression::of_path(path);
+    unsigned long int size_now, mtime_now, inode_now;
+    bool append = codec == Compression::NONE
+        && path == last_export.path
+        && last_export.n_clauses <= size()
+        && last_export.n_equalities == v->n_equalities()
+        && file_status(path, size_now, mtime_now, inode_now)
+        && size_now == last_export.file_size
+        && mtime_now == last_export.mtime
+        && inode_now == last_export.inode
+        && has_marker(path, last_export.fingerprint);
+    if (!append)
+    {
+        last_export.path = path;
+        last_export.n_clauses = 0;
+        last_export.fingerprint = 0xcbf29ce484222325ULL;
+        last_export.n_equalities = v->n_equalities();
+        last_export.codes.clear();
+        last_export.dense.assign(v->size() + 1, 0);
+    }
+    last_export.reused = last_export.n_clauses;
+
+    // The new variables are numbered after those already in the file,
+    // in the order of their first occurrence, so that the file is the
+    // same as if it was written at once.
+    std::vector<long int> & dense = last_export.dense;
+    std::vector<long int> & codes = last_export.codes;
+    for (unsigned long int i=last_export.n_clauses; i<size(); i++)
+        for (const Lit * l = clause_begin(i); l != clause_end(i); l++)
+        {
+            unsigned long int x = v->new_code(*l).var().code();
+            if (x >= dense.size())
+                dense.resize(x + 1, 0);
+            if (dense[x] == 0)
+            {
+                codes.push_back(x);
+                dense[x] = codes.size();
+            }
+        }
+
+    // The fingerprint hashes the literals written, 0 ending each
+    // clause, so that it only depends on the content of the file.
+    uint64_t & fingerprint = last_export.fingerprint;
+    auto write_clauses = [&](std::ostream * out) {
+        for (unsigned long int i=last_export.n_clauses; i<size(); i++)
+        {
+            for (const Lit * l = clause_begin(i); l != clause_end(i); l++)
+            {
+                Lit lit = v->new_code(*l);
+                long int x = dense[lit.var().code()];
+                x = lit.is_negated() ? (-1)*x : x;
+                (*out) << x << " ";
+                fingerprint = (fingerprint ^ (uint64_t)x) * 0x100000001b3ULL;
+            }
+            (*out) << "0\n";
+            fingerprint *= 0x100000001b3ULL;
+        }
+    };
+
+    if (codec != Compression::NONE)
+    {
+        Compression::Output out(path, codec);
+        write_padded_header(&out, codes.size(), size());
+        write_clauses(&out);
+        out.close();
+    }
+    else
+    {
+        std::fstream out;
+        if (append)
+        {
+            out.open(path.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+            out.seekp(0, std::ios::end);
+        }
+        else
+        {
+            out.open(path.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+            out << export_marker(fingerprint) << "\n";
+            write_padded_header(&out, codes.size(), size());
+        }
+        if (!out)
+            throw std::runtime_error("Cannot write " + path + ".");
+        write_clauses(&out);
+        // The marker and the header have a fixed width: they are
+        // rewritten in place with the new fingerprint and numbers.
+        out.seekp(0);
+        out << export_marker(fingerprint) << "\n";
+        write_padded_header(&out, codes.size(), size());
+        out.close();
+        if (out.fail())
+            throw std::runtime_error("Cannot write " + path + ".");
+    }
+
+    last_export.n_clauses = size();
+    file_status(path, last_export.file_size, last_export.mtime, last_export.inode);
+    return DimacsNumbering(codes);
+}
+
+
+unsigned long int Formula::last_export_reused() const
+{
+    return last_export.reused;
+}
+
+
+// !SECTION! Streaming the clauses
+// ================================
+
+/** The size of the buffer through which a streaming formula writes
+ * its clauses. */
+static const unsigned long int STREAM_BUFFER_SIZE = 1 << 20;
+
+/** The largest number of characters written for a literal. */
+static const unsigned long int MAX_LITERAL_LENGTH = 24;
+
+
+/** Writes the literal x followed by a space at p and returns the
+ * position following them. */
+static char * write_literal(char * p, long int x)
+{
+    if (x < 0)
+    {
+        *p++ = '-';
+        x = (-1)*x;
+    }
+    char digits[20];
+    unsigned int n = 0;
+    do
+    {
+        digits[n++] = '0' + x % 10;
+        x /= 10;
+    }
+    while (x > 0);
+    while (n > 0)
+        *p++ = digits[--n];
+    *p++ = ' ';
+    return p;
+}
+
+
+struct Formula::ClauseStream
+{
+    /** The DIMACS file written, empty if the sink is a stream given
+     * by the user. */
+    std::string path;
+
+    /** The codec of the file. If it is not NONE, the clauses are
+     * written in `spool_path`, compressed in `path` at the end. */
+    Compression::Codec codec;
+    std::string spool_path;
+
+    /** The file opened by the formula, if any. */
+    std::ofstream file;
+
+    /** Where the buffer is written. */
+    std::ostream * out;
+
+    /** The clauses not written yet: the first `used` bytes. */
+    std::vector<char> buffer;
+    unsigned long int used;
+
+    /** The number of clauses written. */
+    unsigned long int n_clauses;
+
+    /** The largest variable written, which may be out of the set
+     * if the clauses were not built from its subsets. */
+    unsigned long int max_variable;
+
+    /** The set used to rename the literals. */
+    VariableSet * v;
+
+    /** Is true once finish() was called. */
+    bool finished;
+
+    ClauseStream(VariableSet * _v)
+        : codec(Compression::NONE), out(NULL), buffer(STREAM_BUFFER_SIZE),
+          used(0), n_clauses(0), max_variable(0), v(_v), finished(false) {}
+
+    ~ClauseStream()
+    {
+        if (!finished)
+            try
+            {
+                finish();
+            }
+            catch (std::runtime_error &)
+            {
+            }
+    }
+
+    void flush()
+    {
+        out->write(buffer.data(), used);
+        used = 0;
+        if (!(*out))
+            throw std::runtime_error(
+                "Cannot write " + (path.empty() ? "the stream" : path) + ".");
+    }
+
+    void write(const Clause & c)
+    {
+        for (unsigned int i=0; i<c.size(); i++)
+        {
+            if (used + MAX_LITERAL_LENGTH > buffer.size())
+                flush();
+            long int lit = v->new_code(c[i]);
+            used = write_literal(buffer.data() + used, lit) - buffer.data();
+            max_variable = std::max<unsigned long int>(
+                max_variable, (lit > 0) ? lit : (-1)*lit);
+        }
+        if (used + 2 > buffer.size())
+            flush();
+        buffer[used++] = '0';
+        buffer[used++] = '\n';
+        n_clauses ++;
+    }
+
+    /** Returns the number of variables given by the header. */
+    unsigned long int n_variables() const
+    {
+        return std::max<unsigned long int>(v->size(), max_variable);
+    }
+
+    /** Writes the buffer and the header, and closes the file. */
+    void finish()
+    {
+        finished = true;
+        flush();
+        if (path.empty())
+        {
+            out->flush();
+            return;
+        }
+        if (codec == Compression::NONE)
+        {
+            file.seekp(0);
+            write_padded_header(&file, n_variables(), n_clauses);
+            file.close();
+            if (file.fail())
+                throw std::runtime_error("Cannot write " + path + ".");
+            return;
+        }
+        file.close();
+        if (file.fail())
+            throw std::runtime_error("Cannot write " + spool_path + ".");
+        Compression::Output compressed(path, codec);
+        write_padded_header(&compressed, n_variables(), n_clauses);
+        std::ifstream spool(spool_path.c_str(), std::ios::binary);
+        while (spool.read(buffer.data(), buffer.size()) || spool.gcount() > 0)
+            compressed.write(buffer.data(), spool.gcount());
+        compressed.close();
+        std::remove(spool_path.c_str());
+    }
+};
+
+
+void Formula::start_stream(std::shared_ptr<ClauseStream> s)
+{
+    for (unsigned long int i=0; i<size(); i++)
+        s->write(clause(i));
+    std::vector<Lit> old_literals;
+    std::vector<unsigned long int> old_starts;
+    clear(old_literals, old_starts);
+    stream = s;
+}
+
+
+void Formula::write_to_stream(const Clause & c)
+{
+    stream->write(c);
+}
+
+
+void Formula::stream_to(const std::string & path)
+{
+    if (stream)
+        throw std::logic_error("The formula is already streaming.");
+    std::shared_ptr<ClauseStream> s = std::make_shared<ClauseStream>(v);
+    s->path = path;
+    s->codec = Compression::of_path(path);
+    if (!Compression::available(s->codec))
+        throw std::runtime_error(
+            "libcnf was built without support for the "
+            + Compression::extension(s->codec) + " files.");
+    s->spool_path = (s->codec == Compression::NONE) ? path : path + ".stream.tmp";
+    s->file.open(s->spool_path.c_str(),
+                 std::ios::out | std::ios::trunc | std::ios::binary);
+    if (!s->file)
+        throw std::runtime_error("Cannot write " + s->spool_path + ".");
+    s->out = &s->file;
+    // The header is rewritten with the right numbers at the end.
+    if (s->codec == Compression::NONE)
+        write_padded_header(&s->file, 0, 0);
+    start_stream(s);
+}
+
+
+void Formula::stream_to(std::ostream * out)
+{
+    if (stream)
+        throw std::logic_error("The formula is already streaming.");
+    std::shared_ptr<ClauseStream> s = std::make_shared<ClauseStream>(v);
+    s->out = out;
+    start_stream(s);
+}
+
+
+unsigned long int Formula::end_stream()
+{
+    if (!stream)
+        throw std::logic_error("The formula is not streaming.");
+    std::shared_ptr<ClauseStream> s = stream;
+    stream.reset();
+    s->finish();
+    return s->n_clauses;
+}
+
+
+bool Formula::is_streaming() const
+{
+    return stream != NULL;
+}
+
+
+unsigned long int Formula::n_streamed_clauses() const
+{
+    return stream ? stream->n_clauses : 0;
+}
+
+
+// !SECTION! Using the models
+// ==========================
+
+void Formula::extend_model()
+{
+    // The preprocessor accepts clauses with variables out of the
+    // VariableSet; they have no value and are considered false.
+    auto known = [this](long int lit)
+    {
+        return (unsigned long int)((lit > 0) ? lit : (-1)*lit) <= v->size();
+    };
+    for (auto c = reconstruction_stack.rbegin();
+         c != reconstruction_stack.rend();
+         c++)
+    {
+        // The variables may have been merged with others after the
+        // clause was stored.
+        bool satisfied = false;
+        for (unsigned int i=0; i<c->size() && !satisfied; i++)
+        {
+            long int lit = v->new_code((*c)[i]);
+            satisfied = known(lit) && v->literal_value(lit);
+        }
+        long int pivot = v->new_code((*c)[0]);
+        if (!satisfied && known(pivot))
+            v->set_literal(pivot);
+    }
+    if (!reconstruction_stack.empty())
+        v->propagate_equalities();
 }
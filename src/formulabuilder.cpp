@@ -0,0 +1,149 @@
+/**
+ * @name formulabuilder.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 20:15:37 leo>
+ *
+ * @brief Source code of the FormulaBuilder class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+FormulaBuilder::FormulaBuilder(Formula * _f)
+{
+    f = _f;
+    n_threads = std::thread::hardware_concurrency();
+    if (n_threads == 0)
+        n_threads = 1;
+    deterministic = true;
+}
+
+
+void FormulaBuilder::set_threads(unsigned int n)
+{
+    n_threads = (n > 0) ? n : 1;
+}
+
+
+void FormulaBuilder::set_deterministic(bool enable)
+{
+    deterministic = enable;
+}
+
+
+// !SECTION! Building the shards
+// =============================
+
+Subset FormulaBuilder::add_subset(const std::string & name,
+                                  std::initializer_list<unsigned int> dim)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return f->variables()->add_subset(name, dim);
+}
+
+
+Formula * FormulaBuilder::new_shard()
+{
+    std::unique_ptr<Formula> shard(new Formula(f->variables()));
+    shard->deferring_equalities = true;
+    std::lock_guard<std::mutex> guard(lock);
+    shards.push_back(std::move(shard));
+    return shards.back().get();
+}
+
+
+unsigned int FormulaBuilder::n_shards()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return shards.size();
+}
+
+
+void FormulaBuilder::run(
+    unsigned long int n_tasks,
+    std::function<void(Formula *, unsigned long int)> task)
+{
+    std::vector<Formula *> task_shards;
+    if (deterministic)
+        for (unsigned long int i=0; i<n_tasks; i++)
+            task_shards.push_back(new_shard());
+
+    std::atomic<unsigned long int> next(0);
+    std::vector<std::thread> threads;
+    for (unsigned int t=0; t<n_threads && t<n_tasks; t++)
+        threads.push_back(std::thread([&]() {
+                    Formula * own = NULL;
+                    for (unsigned long int i = next++; i < n_tasks; i = next++)
+                        if (deterministic)
+                            task(task_shards[i], i);
+                        else
+                        {
+                            if (own == NULL)
+                                own = new_shard();
+                            task(own, i);
+                        }
+                }));
+    for (unsigned int t=0; t<threads.size(); t++)
+        threads[t].join();
+    merge();
+}
+
+
+// !SECTION! Merging the shards
+// ============================
+
+void FormulaBuilder::merge()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    if (f->normalizing || f->stream)
+    {
+        // The clauses have to be looked for in the index, or written
+        // in the stream, one after the other.
+        LIBCNF_SOURCE(INTERNAL);
+        for (unsigned int s=0; s<shards.size(); s++)
+            for (unsigned long int i=0; i<shards[s]->size(); i++)
+                f->add_clause(shards[s]->clause(i));
+    }
+    else
+    {
+        // Each shard is copied at its final position by the threads.
+        std::vector<unsigned long int>
+            literal_offsets(shards.size() + 1, f->literals.size()),
+            clause_offsets(shards.size() + 1, f->clause_starts.size());
+        for (unsigned int s=0; s<shards.size(); s++)
+        {
+            literal_offsets[s+1] = literal_offsets[s] + shards[s]->literals.size();
+            clause_offsets[s+1] = clause_offsets[s] + shards[s]->clause_starts.size() - 1;
+        }
+        f->literals.resize(literal_offsets.back());
+        f->clause_starts.resize(clause_offsets.back());
+
+        std::atomic<unsigned int> next(0);
+        std::vector<std::thread> threads;
+        for (unsigned int t=0; t<n_threads && t<shards.size(); t++)
+            threads.push_back(std::thread([&]() {
+                        for (unsigned int s = next++; s < shards.size(); s = next++)
+                        {
+                            const Formula * shard = shards[s].get();
+                            std::copy(shard->literals.begin(),
+                                      shard->literals.end(),
+                                      f->literals.begin() + literal_offsets[s]);
+                            for (unsigned long int i=1; i<shard->clause_starts.size(); i++)
+                                f->clause_starts[clause_offsets[s] + i - 1] =
+                                    literal_offsets[s] + shard->clause_starts[i];
+                        }
+                    }));
+        for (unsigned int t=0; t<threads.size(); t++)
+            threads[t].join();
+    }
+
+    VariableSet * v = f->variables();
+    for (unsigned int s=0; s<shards.size(); s++)
+        for (unsigned long int i=0; i<shards[s]->deferred_equalities.size(); i+=2)
+            v->add_var_equality(shards[s]->deferred_equalities[i],
+                                shards[s]->deferred_equalities[i+1]);
+    shards.clear();
+    LIBCNF_MEMORY(FORMULA, f->memory_usage());
+}
@@ -0,0 +1,131 @@
+/**
+ * @name formulatemplate.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 19:41:12 leo>
+ *
+ * @brief Source code of the FormulaTemplate class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+// !SECTION! Capturing the clauses
+// ===============================
+
+FormulaTemplate::FormulaTemplate(const Formula & f,
+                                 std::vector<CodeRange> _slots)
+    : slots(_slots)
+{
+    clause_starts.push_back(0);
+    for (unsigned long int i=0; i<f.size(); i++)
+    {
+        for (const Lit * l = f.clause_begin(i); l != f.clause_end(i); l++)
+        {
+            long int x = l->var().code();
+            unsigned int s = 0;
+            while (s < slots.size()
+                   && (x < slots[s][0]
+                       || x >= slots[s][0] + (long int)slots[s].size()))
+                s ++;
+            if (s == slots.size())
+            {
+                std::stringstream msg;
+                msg << "The variable " << x
+                    << " is in no slot of the FormulaTemplate.";
+                throw std::domain_error(msg.str());
+            }
+            literals.push_back(*l);
+            literal_slots.push_back(s);
+        }
+        clause_starts.push_back(literals.size());
+    }
+}
+
+
+FormulaTemplate::FormulaTemplate(const Formula & f,
+                                 std::initializer_list<CodeRange> _slots)
+    : FormulaTemplate(f, std::vector<CodeRange>(_slots.begin(), _slots.end()))
+{
+}
+
+
+unsigned long int FormulaTemplate::size() const
+{
+    return clause_starts.size() - 1;
+}
+
+
+unsigned int FormulaTemplate::n_slots() const
+{
+    return slots.size();
+}
+
+
+// !SECTION! Instantiating the template
+// ====================================
+
+void FormulaTemplate::instantiate(Formula * f,
+                                  std::vector<CodeRange> bindings) const
+{
+    LIBCNF_SOURCE(TEMPLATE);
+    if (bindings.size() != slots.size())
+        throw std::domain_error(
+            "A FormulaTemplate needs as many bindings as slots.");
+    std::vector<long int> delta(slots.size());
+    for (unsigned int s=0; s<slots.size(); s++)
+    {
+        if (bindings[s].size() != slots[s].size())
+            throw std::domain_error(
+                "A slot of a FormulaTemplate is bound to a range "
+                "of another size.");
+        delta[s] = bindings[s][0] - slots[s][0];
+    }
+
+    if (f->normalizing || f->stream)
+    {
+        // The clauses have to be looked for in the index, or written
+        // in the stream.
+        for (unsigned long int i=0; i<size(); i++)
+        {
+            std::vector<long int> c(clause_starts[i+1] - clause_starts[i]);
+            for (unsigned long int k=clause_starts[i]; k<clause_starts[i+1]; k++)
+            {
+                long int d = delta[literal_slots[k]], x = literals[k].code();
+                c[k - clause_starts[i]] = (x > 0) ? x + d : x - d;
+            }
+            f->add_clause(Clause(c));
+        }
+        return;
+    }
+
+    // Otherwise, the literals are shifted directly into the arena:
+    // shifting the variable by d adds 2d to the index of a literal,
+    // whatever its sign (modulo 2^32 if d is negative).
+    std::vector<uint32_t> index_shift(delta.size());
+    for (unsigned int s=0; s<delta.size(); s++)
+        index_shift[s] = 2*(uint32_t)delta[s];
+    unsigned long int base = f->literals.size();
+    f->literals.resize(base + literals.size());
+    Lit * out = f->literals.data() + base;
+    const Lit * in = literals.data();
+    const unsigned int * in_slots = literal_slots.data();
+    const uint32_t * shift = index_shift.data();
+    for (unsigned long int k=0; k<literals.size(); k++)
+        out[k] = Lit::from_index(in[k].index() + shift[in_slots[k]]);
+    f->clause_starts.reserve(f->clause_starts.size() + size());
+    for (unsigned long int i=1; i<clause_starts.size(); i++)
+        f->clause_starts.push_back(base + clause_starts[i]);
+    for (unsigned long int i=0; i<size(); i++)
+        LIBCNF_COUNT_CLAUSE(clause_starts[i+1] - clause_starts[i]);
+    LIBCNF_MEMORY(FORMULA, f->memory_usage());
+}
+
+
+void FormulaTemplate::instantiate(
+    Formula * f,
+    std::initializer_list<CodeRange> bindings) const
+{
+    instantiate(f, std::vector<CodeRange>(bindings.begin(), bindings.end()));
+}
@@ -0,0 +1,745 @@
+/**
+ * @name incrementalsolver.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 14:02:37 leo>
+ *
+ * @brief Source code of the IncrementalSolver class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+const unsigned int IncrementalSolver::NO_REASON;
+
+/** Returns the x-th element of the Luby sequence 1 1 2 1 1 2 4 1 1 2
+ * 1 1 2 4 8 ... used to schedule the restarts. */
+static unsigned long int luby(unsigned long int x)
+{
+    unsigned long int size = 1, seq = 0;
+    while (size < x+1)
+    {
+        seq++;
+        size = 2*size + 1;
+    }
+    while (size-1 != x)
+    {
+        size = (size-1) >> 1;
+        seq--;
+        x = x % size;
+    }
+    return 1UL << seq;
+}
+
+
+// !SECTION! Building the solver
+// =============================
+
+IncrementalSolver::IncrementalSolver(VariableSet * _v)
+{
+    v = _v;
+    n_vars = 0;
+    ok = true;
+    qhead = 0;
+    var_inc = 1;
+    cla_inc = 1;
+    max_learnts = 0;
+    was_interrupted = false;
+    stop_flag = NULL;
+    conflict_limit = -1;
+    conflicts_left = -1;
+    n_conflicts = 0;
+    n_decisions = 0;
+    n_propagations = 0;
+    assigns.assign(1, 0);
+    level.assign(1, 0);
+    reason.assign(1, NO_REASON);
+    activity.assign(1, 0);
+    heap_index.assign(1, -1);
+    polarity.assign(1, true);
+    seen.assign(1, false);
+    watches.resize(2);
+    ensure_variables(v->size());
+}
+
+
+void IncrementalSolver::ensure_variables(unsigned int x)
+{
+    if (x <= n_vars)
+        return;
+    assigns.resize(x+1, 0);
+    level.resize(x+1, 0);
+    reason.resize(x+1, NO_REASON);
+    activity.resize(x+1, 0);
+    heap_index.resize(x+1, -1);
+    polarity.resize(x+1, true);
+    seen.resize(x+1, false);
+    watches.resize(2*(x+1));
+    for (unsigned int y=n_vars+1; y<=x; y++)
+        heap_insert(y);
+    n_vars = x;
+}
+
+
+unsigned int IncrementalSolver::internal_literal(long int code)
+{
+    return internal_literal(Lit(code));
+}
+
+
+unsigned int IncrementalSolver::internal_literal(Lit l)
+{
+    Lit renamed = v->new_code(l);
+    ensure_variables(renamed.var().code());
+    return renamed.index();
+}
+
+
+void IncrementalSolver::add_clause(Clause c)
+{
+    std::vector<unsigned int> internal(c.size());
+    for (unsigned int i=0; i<c.size(); i++)
+        internal[i] = internal_literal(c[i]);
+    add_internal_clause(internal);
+}
+
+
+void IncrementalSolver::add_formula(const Formula & f)
+{
+    for (unsigned long int i=0; i<f.size(); i++)
+    {
+        std::vector<unsigned int> internal;
+        internal.reserve(f.clause_end(i) - f.clause_begin(i));
+        for (const Lit * l=f.clause_begin(i); l!=f.clause_end(i); l++)
+            internal.push_back(internal_literal(*l));
+        add_internal_clause(internal);
+    }
+}
+
+
+void IncrementalSolver::add_internal_clause(std::vector<unsigned int> c)
+{
+    if (!ok)
+        return;
+    backtrack(0);
+    // 2x and 2x+1 are next to each other once sorted, so that
+    // duplicates and tautologies are easy to find.
+    std::sort(c.begin(), c.end());
+    unsigned int j = 0;
+    for (unsigned int i=0; i<c.size(); i++)
+    {
+        if (j > 0 && c[i] == c[j-1])
+            continue;
+        if (j > 0 && c[i] == (c[j-1] ^ 1))
+            return;
+        int val = value(c[i]);
+        if (val == 1)
+            return;
+        else if (val == 0)
+            c[j++] = c[i];
+    }
+    c.resize(j);
+
+    if (c.size() == 0)
+        ok = false;
+    else if (c.size() == 1)
+    {
+        enqueue(c[0], NO_REASON);
+        if (propagate() != NO_REASON)
+            ok = false;
+    }
+    else
+    {
+        StoredClause stored = {c, false, false, 0};
+        clauses.push_back(stored);
+        attach(clauses.size()-1);
+    }
+}
+
+
+void IncrementalSolver::attach(unsigned int cref)
+{
+    const std::vector<unsigned int> & c = clauses[cref].lits;
+    Watcher w0 = {cref, c[1]}, w1 = {cref, c[0]};
+    watches[c[0]].push_back(w0);
+    watches[c[1]].push_back(w1);
+}
+
+
+// !SECTION! Propagating and learning
+// ==================================
+
+void IncrementalSolver::enqueue(unsigned int l, unsigned int from)
+{
+    unsigned int x = l >> 1;
+    assigns[x] = (l & 1) ? -1 : 1;
+    level[x] = decision_level();
+    reason[x] = from;
+    trail.push_back(l);
+}
+
+
+unsigned int IncrementalSolver::propagate()
+{
+    unsigned int confl = NO_REASON;
+    while (qhead < trail.size())
+    {
+        unsigned int false_lit = trail[qhead++] ^ 1;
+        std::vector<Watcher> & ws = watches[false_lit];
+        unsigned int i = 0, j = 0, n = ws.size();
+        n_propagations ++;
+        while (i < n)
+        {
+            Watcher w = ws[i++];
+            if (value(w.blocker) == 1)
+            {
+                ws[j++] = w;
+                continue;
+            }
+            std::vector<unsigned int> & c = clauses[w.clause].lits;
+            // The false literal is put in position 1.
+            if (c[0] == false_lit)
+                std::swap(c[0], c[1]);
+            Watcher kept = {w.clause, c[0]};
+            if (c[0] != w.blocker && value(c[0]) == 1)
+            {
+                ws[j++] = kept;
+                continue;
+            }
+            bool found = false;
+            for (unsigned int k=2; k<c.size() && !found; k++)
+                if (value(c[k]) != -1)
+                {
+                    std::swap(c[1], c[k]);
+                    watches[c[1]].push_back(kept);
+                    found = true;
+                }
+            if (found)
+                continue;
+            // The clause is unit or false.
+            ws[j++] = kept;
+            if (value(c[0]) == -1)
+            {
+                confl = w.clause;
+                qhead = trail.size();
+                while (i < n)
+                    ws[j++] = ws[i++];
+            }
+            else
+                enqueue(c[0], w.clause);
+        }
+        ws.resize(j);
+    }
+    return confl;
+}
+
+
+void IncrementalSolver::analyze(unsigned int confl,
+                                std::vector<unsigned int> & learnt,
+                                unsigned int & backtrack_level)
+{
+    learnt.assign(1, 0);
+    unsigned int path = 0, p = NO_REASON;
+    int index = trail.size() - 1;
+    do
+    {
+        if (clauses[confl].learnt)
+            bump_clause(confl);
+        const std::vector<unsigned int> & c = clauses[confl].lits;
+        for (unsigned int k=(p == NO_REASON) ? 0 : 1; k<c.size(); k++)
+        {
+            unsigned int x = c[k] >> 1;
+            if (!seen[x] && level[x] > 0)
+            {
+                bump_variable(x);
+                seen[x] = true;
+                if (level[x] >= decision_level())
+                    path ++;
+                else
+                    learnt.push_back(c[k]);
+            }
+        }
+        while (!seen[trail[index] >> 1])
+            index --;
+        p = trail[index];
+        index --;
+        confl = reason[p >> 1];
+        seen[p >> 1] = false;
+        path --;
+    } while (path > 0);
+    learnt[0] = p ^ 1;
+
+    // Removing the literals implied by the others.
+    std::vector<unsigned int> to_clear(learnt);
+    unsigned int j = 1;
+    for (unsigned int i=1; i<learnt.size(); i++)
+    {
+        unsigned int x = learnt[i] >> 1;
+        bool redundant = (reason[x] != NO_REASON);
+        if (redundant)
+        {
+            const std::vector<unsigned int> & c = clauses[reason[x]].lits;
+            for (unsigned int k=1; k<c.size() && redundant; k++)
+                redundant = seen[c[k] >> 1] || level[c[k] >> 1] == 0;
+        }
+        if (!redundant)
+            learnt[j++] = learnt[i];
+    }
+    learnt.resize(j);
+    for (unsigned int i=0; i<to_clear.size(); i++)
+        seen[to_clear[i] >> 1] = false;
+
+    // The literal with the highest level is put in position 1 so that
+    // it is watched.
+    backtrack_level = 0;
+    if (learnt.size() > 1)
+    {
+        unsigned int max_i = 1;
+        for (unsigned int i=2; i<learnt.size(); i++)
+            if (level[learnt[i] >> 1] > level[learnt[max_i] >> 1])
+                max_i = i;
+        std::swap(learnt[1], learnt[max_i]);
+        backtrack_level = level[learnt[1] >> 1];
+    }
+}
+
+
+void IncrementalSolver::analyze_final(unsigned int p)
+{
+    conflict.assign(1, p);
+    if (decision_level() == 0)
+        return;
+    seen[p >> 1] = true;
+    for (int i=trail.size()-1; i>=(int)trail_lim[0]; i--)
+    {
+        unsigned int x = trail[i] >> 1;
+        if (seen[x])
+        {
+            if (reason[x] == NO_REASON)
+                conflict.push_back(trail[i]);
+            else
+            {
+                const std::vector<unsigned int> & c = clauses[reason[x]].lits;
+                for (unsigned int k=1; k<c.size(); k++)
+                    if (level[c[k] >> 1] > 0)
+                        seen[c[k] >> 1] = true;
+            }
+            seen[x] = false;
+        }
+    }
+    seen[p >> 1] = false;
+}
+
+
+void IncrementalSolver::backtrack(unsigned int target_level)
+{
+    if (decision_level() <= target_level)
+        return;
+    for (int i=trail.size()-1; i>=(int)trail_lim[target_level]; i--)
+    {
+        unsigned int x = trail[i] >> 1;
+        assigns[x] = 0;
+        reason[x] = NO_REASON;
+        polarity[x] = (trail[i] & 1);
+        if (heap_index[x] < 0)
+            heap_insert(x);
+    }
+    trail.resize(trail_lim[target_level]);
+    trail_lim.resize(target_level);
+    qhead = trail.size();
+}
+
+
+// !SECTION! Searching
+// ===================
+
+unsigned int IncrementalSolver::pick_branch_literal()
+{
+    for (unsigned int i=0; i<priority.size(); i++)
+        if (assigns[priority[i]] == 0)
+            return 2*priority[i] + (polarity[priority[i]] ? 1 : 0);
+    while (!heap.empty())
+    {
+        unsigned int x = heap_pop();
+        if (assigns[x] == 0)
+            return 2*x + (polarity[x] ? 1 : 0);
+    }
+    return NO_REASON;
+}
+
+
+bool IncrementalSolver::must_stop() const
+{
+    return (stop_flag != NULL && stop_flag->load(std::memory_order_relaxed))
+        || conflicts_left == 0;
+}
+
+
+int IncrementalSolver::search(long int n_allowed_conflicts)
+{
+    std::vector<unsigned int> learnt;
+    long int n_local_conflicts = 0;
+    while (true)
+    {
+        unsigned int confl = propagate();
+        if (confl != NO_REASON)
+        {
+            n_conflicts ++;
+            n_local_conflicts ++;
+            if (conflicts_left > 0)
+                conflicts_left --;
+            if (decision_level() == 0)
+            {
+                ok = false;
+                return -1;
+            }
+            unsigned int backtrack_level;
+            analyze(confl, learnt, backtrack_level);
+            backtrack(backtrack_level);
+            if (learnt.size() == 1)
+                enqueue(learnt[0], NO_REASON);
+            else
+            {
+                StoredClause stored = {learnt, true, false, 0};
+                unsigned int cref = clauses.size();
+                clauses.push_back(stored);
+                learnts.push_back(cref);
+                attach(cref);
+                bump_clause(cref);
+                enqueue(learnt[0], cref);
+            }
+            var_inc /= 0.95;
+            cla_inc /= 0.999;
+        }
+        else
+        {
+            if (n_local_conflicts >= n_allowed_conflicts || must_stop())
+            {
+                backtrack(0);
+                return 0;
+            }
+            if (learnts.size() >= max_learnts + trail.size())
+                reduce_db();
+
+            // The assumptions are the first decisions.
+            unsigned int next = NO_REASON;
+            while (next == NO_REASON && decision_level() < assumptions.size())
+            {
+                unsigned int a = assumptions[decision_level()];
+                if (value(a) == 1)
+                    trail_lim.push_back(trail.size());
+                else if (value(a) == -1)
+                {
+                    analyze_final(a);
+                    return -1;
+                }
+                else
+                    next = a;
+            }
+            if (next == NO_REASON)
+            {
+                next = pick_branch_literal();
+                if (next == NO_REASON)
+                    return 1;
+            }
+            n_decisions ++;
+            trail_lim.push_back(trail.size());
+            enqueue(next, NO_REASON);
+        }
+    }
+}
+
+
+bool IncrementalSolver::solve()
+{
+    return solve(std::vector<long int>());
+}
+
+
+bool IncrementalSolver::solve(std::initializer_list<long int> assumed)
+{
+    return solve(std::vector<long int>(assumed));
+}
+
+
+bool IncrementalSolver::solve(std::vector<long int> assumed)
+{
+    LIBCNF_TIMER(SOLVE);
+    model.clear();
+    model_decisions.clear();
+    conflict.clear();
+    was_interrupted = false;
+    assumption_codes = assumed;
+    assumptions.resize(assumed.size());
+    for (unsigned int i=0; i<assumed.size(); i++)
+        assumptions[i] = internal_literal(assumed[i]);
+    if (!ok)
+        return false;
+    backtrack(0);
+
+    conflicts_left = conflict_limit;
+    double min_learnts = (clauses.size() - learnts.size()) / 3.0;
+    if (max_learnts < min_learnts)
+        max_learnts = min_learnts;
+    if (max_learnts < 2000)
+        max_learnts = 2000;
+    int status = 0;
+    for (unsigned long int restarts=0; status == 0; restarts++)
+    {
+        if (must_stop())
+        {
+            was_interrupted = true;
+            break;
+        }
+        status = search(100*luby(restarts));
+        max_learnts *= 1.02;
+    }
+
+    if (status == 1)
+    {
+        model = assigns;
+        for (unsigned int l=0; l<trail_lim.size(); l++)
+            if (trail_lim[l] < trail.size())
+            {
+                unsigned int d = trail[trail_lim[l]];
+                if (level[d >> 1] == l+1 && reason[d >> 1] == NO_REASON)
+                    model_decisions.push_back(d);
+            }
+    }
+    backtrack(0);
+    return status == 1;
+}
+
+
+void IncrementalSolver::reduce_db()
+{
+    std::sort(learnts.begin(), learnts.end(),
+              [this](unsigned int a, unsigned int b) {
+                  return clauses[a].activity < clauses[b].activity;
+              });
+    std::vector<unsigned int> kept;
+    unsigned int n_removed = 0;
+    for (unsigned int i=0; i<learnts.size(); i++)
+    {
+        StoredClause & c = clauses[learnts[i]];
+        unsigned int x = c.lits[0] >> 1;
+        bool locked = reason[x] == learnts[i] && value(c.lits[0]) == 1;
+        if (n_removed < learnts.size()/2 && c.lits.size() > 2 && !locked)
+        {
+            c.deleted = true;
+            std::vector<unsigned int>().swap(c.lits);
+            n_removed ++;
+        }
+        else
+            kept.push_back(learnts[i]);
+    }
+    learnts.swap(kept);
+    for (unsigned int l=0; l<watches.size(); l++)
+    {
+        unsigned int j = 0;
+        for (unsigned int i=0; i<watches[l].size(); i++)
+            if (!clauses[watches[l][i].clause].deleted)
+                watches[l][j++] = watches[l][i];
+        watches[l].resize(j);
+    }
+}
+
+
+// !SECTION! Heuristics
+// ====================
+
+void IncrementalSolver::bump_variable(unsigned int x)
+{
+    activity[x] += var_inc;
+    if (activity[x] > 1e100)
+    {
+        for (unsigned int y=1; y<=n_vars; y++)
+            activity[y] *= 1e-100;
+        var_inc *= 1e-100;
+    }
+    if (heap_index[x] >= 0)
+        heap_up(heap_index[x]);
+}
+
+
+void IncrementalSolver::bump_clause(unsigned int cref)
+{
+    clauses[cref].activity += cla_inc;
+    if (clauses[cref].activity > 1e20)
+    {
+        for (unsigned int i=0; i<learnts.size(); i++)
+            clauses[learnts[i]].activity *= 1e-20;
+        cla_inc *= 1e-20;
+    }
+}
+
+
+void IncrementalSolver::heap_insert(unsigned int x)
+{
+    heap_index[x] = heap.size();
+    heap.push_back(x);
+    heap_up(heap.size()-1);
+}
+
+
+void IncrementalSolver::heap_up(unsigned int i)
+{
+    unsigned int x = heap[i];
+    while (i > 0 && activity[heap[(i-1)/2]] < activity[x])
+    {
+        heap[i] = heap[(i-1)/2];
+        heap_index[heap[i]] = i;
+        i = (i-1)/2;
+    }
+    heap[i] = x;
+    heap_index[x] = i;
+}
+
+
+void IncrementalSolver::heap_down(unsigned int i)
+{
+    unsigned int x = heap[i];
+    while (2*i+1 < heap.size())
+    {
+        unsigned int child = 2*i+1;
+        if (child+1 < heap.size()
+            && activity[heap[child+1]] > activity[heap[child]])
+            child ++;
+        if (activity[heap[child]] <= activity[x])
+            break;
+        heap[i] = heap[child];
+        heap_index[heap[i]] = i;
+        i = child;
+    }
+    heap[i] = x;
+    heap_index[x] = i;
+}
+
+
+unsigned int IncrementalSolver::heap_pop()
+{
+    unsigned int x = heap[0];
+    heap[0] = heap.back();
+    heap_index[heap[0]] = 0;
+    heap.pop_back();
+    heap_index[x] = -1;
+    if (!heap.empty())
+        heap_down(0);
+    return x;
+}
+
+
+long int IncrementalSolver::probe(long int lit)
+{
+    unsigned int l = internal_literal(lit);
+    backtrack(0);
+    if (!ok || value(l) == -1)
+        return -1;
+    else if (value(l) == 1)
+        return 0;
+    trail_lim.push_back(trail.size());
+    enqueue(l, NO_REASON);
+    bool conflicting = (propagate() != NO_REASON);
+    long int n_assigned = trail.size() - trail_lim[0];
+    backtrack(0);
+    return conflicting ? -1 : n_assigned;
+}
+
+
+void IncrementalSolver::set_priority(std::vector<long int> codes)
+{
+    priority.clear();
+    for (unsigned int i=0; i<codes.size(); i++)
+        priority.push_back(internal_literal(codes[i]) >> 1);
+}
+
+
+void IncrementalSolver::set_phase(long int lit)
+{
+    unsigned int l = internal_literal(lit);
+    polarity[l >> 1] = (l & 1);
+}
+
+
+void IncrementalSolver::set_phases(std::vector<long int> lits)
+{
+    for (unsigned int i=0; i<lits.size(); i++)
+        set_phase(lits[i]);
+}
+
+
+// !SECTION! Using the results
+// ===========================
+
+bool IncrementalSolver::interrupted() const
+{
+    return was_interrupted;
+}
+
+
+void IncrementalSolver::set_stop_flag(const std::atomic<bool> * flag)
+{
+    stop_flag = flag;
+}
+
+
+void IncrementalSolver::set_conflict_limit(long int limit)
+{
+    conflict_limit = limit;
+}
+
+
+std::vector<long int> IncrementalSolver::failed_assumptions() const
+{
+    std::vector<long int> result;
+    for (unsigned int i=0; i<assumptions.size(); i++)
+        if (std::find(conflict.begin(), conflict.end(), assumptions[i])
+            != conflict.end())
+            result.push_back(assumption_codes[i]);
+    return result;
+}
+
+
+bool IncrementalSolver::model_value(long int lit)
+{
+    if (model.empty())
+        throw std::logic_error("No model was found by the solver.");
+    unsigned int l = internal_literal(lit);
+    int val = ((l >> 1) < model.size()) ? model[l >> 1] : -1;
+    return (l & 1) ? (val < 0) : (val > 0);
+}
+
+
+std::vector<long int> IncrementalSolver::model_decision_literals() const
+{
+    std::vector<long int> result(model_decisions.size());
+    for (unsigned int i=0; i<model_decisions.size(); i++)
+        result[i] = code(model_decisions[i]);
+    return result;
+}
+
+
+void IncrementalSolver::store_model()
+{
+    if (model.empty())
+        throw std::logic_error("No model was found by the solver.");
+    v->clear_assignment();
+    for (unsigned long int x=1; x<model.size() && x<=v->size(); x++)
+        v->set_literal((model[x] > 0) ? x : (-1)*(long int)x);
+    v->propagate_equalities();
+}
+
+
+unsigned int IncrementalSolver::n_variables() const
+{
+    return n_vars;
+}
+
+
+void IncrementalSolver::print_statistics() const
+{
+    std::cout << "conflicts: " << n_conflicts << std::endl
+              << "decisions: " << n_decisions << std::endl
+              << "propagations: " << n_propagations << std::endl;
+}
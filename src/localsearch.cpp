@@ -0,0 +1,317 @@
+/**
+ * @name localsearch.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 17:30:44 leo>
+ *
+ * @brief Source code of the LocalSearch class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+/** The size of the table of the probabilities of the break values. */
+#define BREAK_TABLE_SIZE 64
+
+
+// !SECTION! Loading the clauses
+// =============================
+
+LocalSearch::LocalSearch(Formula * _f)
+{
+    f = _f;
+    n_threads = 1;
+    seed = 1;
+    flips_per_try = 1000000;
+    cb = 2.3;
+    time_budget = 10;
+    stop_flag = NULL;
+    n_flips = 0;
+    has_empty_clause = false;
+
+    VariableSet * v = f->variables();
+    n_vars = v->size();
+    clause_starts.push_back(0);
+    std::vector<unsigned int> c;
+    for (unsigned long int i=0; i<f->size(); i++)
+    {
+        c.clear();
+        for (const Lit * l=f->clause_begin(i); l!=f->clause_end(i); l++)
+        {
+            Lit x = v->new_code(*l);
+            if (x.var().code() > n_vars)
+                n_vars = x.var().code();
+            c.push_back(x.index());
+        }
+        // The counts of true literals are wrong if a literal appears
+        // twice, and tautologies are useless.
+        std::sort(c.begin(), c.end());
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        bool tautology = false;
+        for (unsigned int k=1; k<c.size(); k++)
+            if (c[k] == (c[k-1] ^ 1))
+                tautology = true;
+        if (tautology)
+            continue;
+        if (c.empty())
+            has_empty_clause = true;
+        literals.insert(literals.end(), c.begin(), c.end());
+        clause_starts.push_back(literals.size());
+    }
+
+    occurrence_starts.assign(2*n_vars + 3, 0);
+    for (unsigned int k=0; k<literals.size(); k++)
+        occurrence_starts[literals[k]+1] ++;
+    for (unsigned int l=1; l<occurrence_starts.size(); l++)
+        occurrence_starts[l] += occurrence_starts[l-1];
+    occurrences.resize(literals.size());
+    std::vector<unsigned int> position(occurrence_starts);
+    for (unsigned int i=0; i+1<clause_starts.size(); i++)
+        for (unsigned int k=clause_starts[i]; k<clause_starts[i+1]; k++)
+            occurrences[position[literals[k]]++] = i;
+}
+
+
+void LocalSearch::set_threads(unsigned int n)
+{
+    n_threads = (n > 0) ? n : 1;
+}
+
+
+void LocalSearch::set_seed(unsigned long int s)
+{
+    seed = s;
+}
+
+
+void LocalSearch::set_flips_per_try(unsigned long int n)
+{
+    flips_per_try = (n > 0) ? n : 1;
+}
+
+
+void LocalSearch::set_break_exponent(double _cb)
+{
+    cb = _cb;
+}
+
+
+void LocalSearch::set_time_budget(double seconds)
+{
+    time_budget = seconds;
+}
+
+
+void LocalSearch::set_phases(std::vector<long int> lits)
+{
+    VariableSet * v = f->variables();
+    hints.assign(n_vars+1, 0);
+    for (unsigned int i=0; i<lits.size(); i++)
+    {
+        long int l = v->new_code(lits[i]);
+        unsigned long int x = (l > 0) ? l : (-1)*l;
+        if (x <= n_vars)
+            hints[x] = (l > 0) ? 1 : -1;
+    }
+}
+
+
+void LocalSearch::set_stop_flag(const std::atomic<bool> * flag)
+{
+    stop_flag = flag;
+}
+
+
+// !SECTION! Searching
+// ===================
+
+bool LocalSearch::search(unsigned long int thread_seed,
+                         const std::atomic<bool> * stop,
+                         std::chrono::steady_clock::time_point deadline,
+                         std::vector<signed char> & model,
+                         unsigned long int & flips)
+{
+    // xorshift64
+    uint64_t state = thread_seed * 0x9e3779b97f4a7c15ULL + 1;
+    auto random = [&state]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    double table[BREAK_TABLE_SIZE];
+    for (unsigned int b=0; b<BREAK_TABLE_SIZE; b++)
+        table[b] = std::pow(1.0 + b, -cb);
+
+    unsigned int n_clauses = clause_starts.size() - 1;
+    std::vector<unsigned char> value(n_vars+1);
+    std::vector<unsigned int>
+        true_count(n_clauses),
+        critical(n_clauses),
+        breaks(n_vars+1),
+        unsat,
+        unsat_position(n_clauses);
+    std::vector<double> probabilities;
+
+    for (bool first_try=true; true; first_try=false)
+    {
+        // A random assignment, unless hints are given; `critical` is
+        // the xor of the variables of the true literals of a clause,
+        // i.e. the only one of them when there is one.
+        for (unsigned int x=1; x<=n_vars; x++)
+            if (first_try && !hints.empty() && hints[x] != 0)
+                value[x] = (hints[x] > 0);
+            else
+                value[x] = random() & 1;
+        std::fill(breaks.begin(), breaks.end(), 0);
+        unsat.clear();
+        for (unsigned int i=0; i<n_clauses; i++)
+        {
+            unsigned int count = 0, xor_vars = 0;
+            for (unsigned int k=clause_starts[i]; k<clause_starts[i+1]; k++)
+                if (value[literals[k] >> 1] != (literals[k] & 1))
+                {
+                    count ++;
+                    xor_vars ^= literals[k] >> 1;
+                }
+            true_count[i] = count;
+            critical[i] = xor_vars;
+            if (count == 0)
+            {
+                unsat_position[i] = unsat.size();
+                unsat.push_back(i);
+            }
+            else if (count == 1)
+                breaks[xor_vars] ++;
+        }
+
+        for (unsigned long int flip=0; flip<flips_per_try; flip++)
+        {
+            if (unsat.empty())
+            {
+                model.assign(value.begin(), value.end());
+                return true;
+            }
+            if ((flip & 1023) == 0
+                && (stop->load(std::memory_order_relaxed)
+                    || (stop_flag != NULL && stop_flag->load(std::memory_order_relaxed))
+                    || std::chrono::steady_clock::now() > deadline))
+                return false;
+
+            // Picking the variable to flip in a falsified clause.
+            unsigned int c = unsat[random() % unsat.size()];
+            unsigned int first = clause_starts[c], last = clause_starts[c+1];
+            probabilities.resize(last - first);
+            double sum = 0;
+            for (unsigned int k=first; k<last; k++)
+            {
+                unsigned int b = breaks[literals[k] >> 1];
+                sum += probabilities[k-first] = (b < BREAK_TABLE_SIZE) ?
+                    table[b] : std::pow(1.0 + b, -cb);
+            }
+            double r = (random() >> 11) * (1.0 / 9007199254740992.0) * sum;
+            unsigned int k = first;
+            while (k+1 < last && r >= probabilities[k-first])
+            {
+                r -= probabilities[k-first];
+                k ++;
+            }
+            unsigned int x = literals[k] >> 1;
+
+            // Flipping it and updating the counts and break values.
+            value[x] ^= 1;
+            flips ++;
+            unsigned int made_true = 2*x + (value[x] ? 0 : 1);
+            for (unsigned int o=occurrence_starts[made_true];
+                 o<occurrence_starts[made_true+1];
+                 o++)
+            {
+                unsigned int i = occurrences[o];
+                unsigned int count = ++true_count[i];
+                if (count == 1)
+                {
+                    unsat[unsat_position[i]] = unsat.back();
+                    unsat_position[unsat.back()] = unsat_position[i];
+                    unsat.pop_back();
+                    breaks[x] ++;
+                }
+                else if (count == 2)
+                    breaks[critical[i]] --;
+                critical[i] ^= x;
+            }
+            unsigned int made_false = made_true ^ 1;
+            for (unsigned int o=occurrence_starts[made_false];
+                 o<occurrence_starts[made_false+1];
+                 o++)
+            {
+                unsigned int i = occurrences[o];
+                unsigned int count = --true_count[i];
+                critical[i] ^= x;
+                if (count == 0)
+                {
+                    breaks[x] --;
+                    unsat_position[i] = unsat.size();
+                    unsat.push_back(i);
+                }
+                else if (count == 1)
+                    breaks[critical[i]] ++;
+            }
+        }
+    }
+}
+
+
+bool LocalSearch::run()
+{
+    n_flips = 0;
+    if (has_empty_clause)
+        return false;
+    std::chrono::steady_clock::time_point deadline
+        = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(time_budget));
+
+    std::atomic<bool> stop(false);
+    std::atomic<unsigned long int> flips(0);
+    std::mutex model_lock;
+    std::vector<signed char> model;
+    bool found = false;
+    std::vector<std::thread> threads;
+    for (unsigned int t=0; t<n_threads; t++)
+        threads.push_back(std::thread([&, t]() {
+                    std::vector<signed char> local_model;
+                    unsigned long int local_flips = 0;
+                    if (search(seed + t, &stop, deadline, local_model, local_flips))
+                    {
+                        std::lock_guard<std::mutex> guard(model_lock);
+                        if (!found)
+                        {
+                            found = true;
+                            model.swap(local_model);
+                        }
+                        stop = true;
+                    }
+                    flips += local_flips;
+                }));
+    for (unsigned int t=0; t<n_threads; t++)
+        threads[t].join();
+    n_flips = flips;
+    if (!found)
+        return false;
+
+    VariableSet * v = f->variables();
+    v->clear_assignment();
+    for (unsigned long int x=1; x<=v->size() && x<=n_vars; x++)
+        if (model[x])
+            v->set_literal(x);
+    v->propagate_equalities();
+    f->extend_model();
+    return true;
+}
+
+
+void LocalSearch::print_statistics() const
+{
+    std::cout << "flips: " << n_flips << std::endl;
+}
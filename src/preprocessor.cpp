@@ -0,0 +1,779 @@
+/**
+ * @name preprocessor.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 10:12:03 leo>
+ *
+ * @brief Source code of the Preprocessor class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+/** Removes the element x from the vector (the order is not kept). */
+static void unordered_erase(std::vector<unsigned int> & vec, unsigned int x)
+{
+    for (unsigned int k=0; k<vec.size(); k++)
+        if (vec[k] == x)
+        {
+            vec[k] = vec.back();
+            vec.pop_back();
+            return;
+        }
+}
+
+
+// !SECTION! Setting up the preprocessor
+// =====================================
+
+Preprocessor::Preprocessor()
+{
+    enabled.assign(N_PASSES, true);
+    time_budget.assign(N_PASSES, 1.0);
+    elimination_occurrence_limit = 16;
+    elimination_clause_limit = 20;
+}
+
+
+void Preprocessor::set_pass(Pass p, bool enable)
+{
+    enabled[p] = enable;
+}
+
+
+void Preprocessor::set_time_budget(Pass p, double seconds)
+{
+    time_budget[p] = seconds;
+}
+
+
+void Preprocessor::set_elimination_limits(unsigned int occurrence_limit,
+                                          unsigned int clause_limit)
+{
+    elimination_occurrence_limit = occurrence_limit;
+    elimination_clause_limit = clause_limit;
+}
+
+
+void Preprocessor::freeze(long int code)
+{
+    frozen_codes.push_back(code);
+}
+
+
+void Preprocessor::start_pass(Pass p)
+{
+    deadline = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(time_budget[p]));
+}
+
+
+bool Preprocessor::out_of_time()
+{
+    return std::chrono::steady_clock::now() > deadline;
+}
+
+
+// !SECTION! Running the preprocessing
+// ===================================
+
+bool Preprocessor::run(Formula * _f)
+{
+    LIBCNF_TIMER(PREPROCESS);
+    f = _f;
+    unsat = false;
+    n_removed_clauses = 0;
+    n_removed_literals = 0;
+    n_fixed_variables = 0;
+    n_eliminated_variables = 0;
+    n_merged_variables = 0;
+
+    load();
+    if (!unsat && enabled[UNITS])
+    {
+        start_pass(UNITS);
+        for (unsigned int i=0; i<clauses.size() && !unsat && !out_of_time(); i++)
+            if (!removed[i] && clauses[i].size() == 1)
+                fix(clauses[i][0]);
+    }
+    if (!unsat && enabled[EQUIVALENCES])
+    {
+        start_pass(EQUIVALENCES);
+        find_equivalences();
+    }
+    if (!unsat && enabled[DUPLICATES])
+    {
+        start_pass(DUPLICATES);
+        remove_duplicates();
+    }
+    if (!unsat && enabled[SUBSUMPTION])
+    {
+        start_pass(SUBSUMPTION);
+        subsume();
+    }
+    if (!unsat && enabled[PROBING])
+    {
+        start_pass(PROBING);
+        probe();
+    }
+    if (!unsat && enabled[ELIMINATION])
+    {
+        start_pass(ELIMINATION);
+        eliminate();
+    }
+    store();
+    return !unsat;
+}
+
+
+void Preprocessor::load()
+{
+    VariableSet * v = f->v;
+    std::vector<std::vector<long int> > renamed;
+    long int n_vars = v->size();
+    for (unsigned long int i=0; i<f->size(); i++)
+    {
+        std::vector<long int> c;
+        for (const Lit * l=f->clause_begin(i); l!=f->clause_end(i); l++)
+        {
+            long int lit = v->new_code(*l).code();
+            long int x = (lit > 0) ? lit : (-1)*lit;
+            n_vars = (x > n_vars) ? x : n_vars;
+            c.push_back(lit);
+        }
+        renamed.push_back(c);
+    }
+
+    clauses.clear();
+    removed.clear();
+    trail.clear();
+    subsumption_queue.clear();
+    n_fixed = 0;
+    occurrences.assign(2*n_vars + 2, std::vector<unsigned int>());
+    marks.assign(2*n_vars + 2, false);
+    assignment.assign(n_vars + 1, 0);
+    is_eliminated.assign(n_vars + 1, false);
+    is_frozen.assign(n_vars + 1, false);
+    for (unsigned int i=0; i<frozen_codes.size(); i++)
+    {
+        long int x = v->new_code(frozen_codes[i]);
+        x = (x > 0) ? x : (-1)*x;
+        if (x <= n_vars)
+            is_frozen[x] = true;
+    }
+
+    for (unsigned int i=0; i<renamed.size(); i++)
+    {
+        std::vector<long int> & c = renamed[i];
+        std::sort(c.begin(), c.end(), literal_order);
+        unsigned int before = c.size();
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        n_removed_literals += before - c.size();
+        bool tautology = false;
+        for (unsigned int j=1; j<c.size() && !tautology; j++)
+            tautology = (c[j] == no(c[j-1]));
+        if (c.empty())
+            unsat = true;
+        else if (tautology)
+            n_removed_clauses ++;
+        else
+            add(c);
+    }
+}
+
+
+void Preprocessor::store()
+{
+    LIBCNF_SOURCE(INTERNAL);
+    std::vector<Lit> old_literals;
+    std::vector<unsigned long int> old_starts;
+    f->clear(old_literals, old_starts);
+    if (unsat)
+        f->add_clause(Clause());
+    else
+    {
+        // Frozen variables keep their value in the formula since
+        // clauses may be added later.
+        for (unsigned int i=0; i<n_fixed; i++)
+            if (is_frozen[(trail[i] > 0) ? trail[i] : (-1)*trail[i]])
+                f->add_clause(Clause{trail[i]});
+        for (unsigned int i=0; i<clauses.size(); i++)
+            if (!removed[i])
+                f->add_clause(Clause(clauses[i]));
+    }
+    clauses.clear();
+    removed.clear();
+    occurrences.clear();
+}
+
+
+// !SECTION! Modifying the clauses
+// ===============================
+
+void Preprocessor::add(std::vector<long int> c)
+{
+    unsigned int index = clauses.size();
+    for (unsigned int j=0; j<c.size(); j++)
+        occurrences[lit_index(c[j])].push_back(index);
+    clauses.push_back(c);
+    removed.push_back(false);
+}
+
+
+void Preprocessor::remove_clause(unsigned int i)
+{
+    removed[i] = true;
+    n_removed_clauses ++;
+    for (unsigned int j=0; j<clauses[i].size(); j++)
+        unordered_erase(occurrences[lit_index(clauses[i][j])], i);
+}
+
+
+void Preprocessor::remove_literal(unsigned int i, long int l)
+{
+    std::vector<long int> & c = clauses[i];
+    for (unsigned int j=0; j<c.size(); j++)
+        if (c[j] == l)
+        {
+            c.erase(c.begin() + j);
+            break;
+        }
+    unordered_erase(occurrences[lit_index(l)], i);
+    n_removed_literals ++;
+    subsumption_queue.push_back(i);
+}
+
+
+void Preprocessor::assign(long int l)
+{
+    assignment[(l > 0) ? l : (-1)*l] = (l > 0) ? 1 : -1;
+    trail.push_back(l);
+}
+
+
+void Preprocessor::fix(long int l)
+{
+    if (lit_value(l) == 1)
+        return;
+    else if (lit_value(l) == -1)
+    {
+        unsat = true;
+        return;
+    }
+    assign(l);
+    while (n_fixed < trail.size() && !unsat)
+    {
+        long int t = trail[n_fixed];
+        n_fixed ++;
+        n_fixed_variables ++;
+        f->reconstruction_stack.push_back(Clause{t});
+
+        std::vector<unsigned int> occ = occurrences[lit_index(t)];
+        for (unsigned int k=0; k<occ.size(); k++)
+            remove_clause(occ[k]);
+
+        occ = occurrences[lit_index(no(t))];
+        for (unsigned int k=0; k<occ.size() && !unsat; k++)
+        {
+            remove_literal(occ[k], no(t));
+            std::vector<long int> & c = clauses[occ[k]];
+            if (c.empty() || (c.size() == 1 && lit_value(c[0]) == -1))
+                unsat = true;
+            else if (c.size() == 1 && lit_value(c[0]) == 0)
+                assign(c[0]);
+        }
+    }
+}
+
+
+bool Preprocessor::propagate(unsigned int start)
+{
+    for (unsigned int i=start; i<trail.size(); i++)
+    {
+        std::vector<unsigned int> & occ = occurrences[lit_index(no(trail[i]))];
+        for (unsigned int k=0; k<occ.size(); k++)
+        {
+            std::vector<long int> & c = clauses[occ[k]];
+            unsigned int n_unassigned = 0;
+            long int last_unassigned = 0;
+            bool satisfied = false;
+            for (unsigned int j=0; j<c.size() && !satisfied; j++)
+            {
+                int val = lit_value(c[j]);
+                if (val == 1)
+                    satisfied = true;
+                else if (val == 0)
+                {
+                    n_unassigned ++;
+                    last_unassigned = c[j];
+                }
+            }
+            if (satisfied)
+                continue;
+            else if (n_unassigned == 0)
+                return false;
+            else if (n_unassigned == 1)
+                assign(last_unassigned);
+        }
+    }
+    return true;
+}
+
+
+void Preprocessor::backtrack(unsigned int start)
+{
+    for (unsigned int i=start; i<trail.size(); i++)
+        assignment[(trail[i] > 0) ? trail[i] : (-1)*trail[i]] = 0;
+    trail.resize(start);
+}
+
+
+// !SECTION! Simplification passes
+// ===============================
+
+void Preprocessor::find_equivalences()
+{
+    // Building the implication graph: the binary clause (a or b)
+    // gives the edges no(a) -> b and no(b) -> a. Node lit_index(l)
+    // is the literal l and its negation is node lit_index(l)^1.
+    unsigned int n_nodes = occurrences.size();
+    std::vector<unsigned int> first_edge(n_nodes + 1, 0), edges;
+    for (unsigned int i=0; i<clauses.size(); i++)
+        if (!removed[i] && clauses[i].size() == 2)
+        {
+            first_edge[lit_index(no(clauses[i][0])) + 1] ++;
+            first_edge[lit_index(no(clauses[i][1])) + 1] ++;
+        }
+    for (unsigned int u=0; u<n_nodes; u++)
+        first_edge[u+1] += first_edge[u];
+    edges.resize(first_edge[n_nodes]);
+    std::vector<unsigned int> position(first_edge.begin(), first_edge.end() - 1);
+    for (unsigned int i=0; i<clauses.size(); i++)
+        if (!removed[i] && clauses[i].size() == 2)
+        {
+            long int a = clauses[i][0], b = clauses[i][1];
+            edges[position[lit_index(no(a))]++] = lit_index(b);
+            edges[position[lit_index(no(b))]++] = lit_index(a);
+        }
+
+    // Iterative version of Tarjan's algorithm. `position` is reused
+    // to store the next edge to explore from each node.
+    std::vector<unsigned int>
+        index(n_nodes, 0),
+        lowlink(n_nodes, 0),
+        call_stack,
+        component_stack;
+    std::vector<bool> on_stack(n_nodes, false);
+    std::vector<long int> substitute(assignment.size(), 0);
+    unsigned int counter = 1;
+    for (unsigned int root=2; root<n_nodes && !unsat; root++)
+    {
+        if (index[root] != 0 || first_edge[root] == first_edge[root+1])
+            continue;
+        if (out_of_time())
+            break;
+        index[root] = lowlink[root] = counter++;
+        position[root] = first_edge[root];
+        call_stack.push_back(root);
+        component_stack.push_back(root);
+        on_stack[root] = true;
+        while (!call_stack.empty() && !unsat)
+        {
+            unsigned int u = call_stack.back();
+            if (position[u] < first_edge[u+1])
+            {
+                unsigned int w = edges[position[u]++];
+                if (index[w] == 0)
+                {
+                    index[w] = lowlink[w] = counter++;
+                    position[w] = first_edge[w];
+                    call_stack.push_back(w);
+                    component_stack.push_back(w);
+                    on_stack[w] = true;
+                }
+                else if (on_stack[w] && index[w] < lowlink[u])
+                    lowlink[u] = index[w];
+                continue;
+            }
+            call_stack.pop_back();
+            if (!call_stack.empty() && lowlink[u] < lowlink[call_stack.back()])
+                lowlink[call_stack.back()] = lowlink[u];
+            if (lowlink[u] != index[u])
+                continue;
+
+            // u is the root of a component: its literals are all
+            // equivalent to the one with the smallest variable, or
+            // to the smallest frozen one if there is one, since
+            // frozen variables are never substituted.
+            std::vector<long int> component;
+            unsigned int w;
+            do
+            {
+                w = component_stack.back();
+                component_stack.pop_back();
+                on_stack[w] = false;
+                component.push_back((w & 1) ? (-1)*(long int)(w/2) : w/2);
+            } while (w != u);
+            if (component.size() == 1)
+                continue;
+            long int representative = component[0];
+            bool frozen_representative = false;
+            for (unsigned int k=0; k<component.size(); k++)
+            {
+                long int l = component[k];
+                bool frozen = is_frozen[(l > 0) ? l : (-1)*l];
+                marks[lit_index(l)] = true;
+                if ((frozen && !frozen_representative)
+                    || (frozen == frozen_representative
+                        && literal_order(l, representative)))
+                {
+                    representative = l;
+                    frozen_representative = frozen;
+                }
+            }
+            for (unsigned int k=0; k<component.size(); k++)
+            {
+                long int l = component[k];
+                long int x = (l > 0) ? l : (-1)*l;
+                if (marks[lit_index(no(l))])
+                    unsat = true;
+                else if (l != representative && !is_frozen[x])
+                    substitute[x] = (l > 0) ? representative : no(representative);
+            }
+            for (unsigned int k=0; k<component.size(); k++)
+                marks[lit_index(component[k])] = false;
+        }
+    }
+    if (unsat)
+        return;
+
+    // Substituting the variables in the clauses of this formula
+    // only: the VariableSet may be shared by other formulas. The
+    // reconstruction stack gets the clauses x = r so that
+    // extend_model() copies the value of r into x.
+    std::vector<bool> to_rewrite(clauses.size(), false);
+    std::vector<unsigned int> rewritten;
+    for (long int x=1; x<(long int)substitute.size(); x++)
+        if (substitute[x] != 0)
+        {
+            long int r = substitute[x];
+            f->reconstruction_stack.push_back(Clause{x, no(r)});
+            f->reconstruction_stack.push_back(Clause{no(x), r});
+            is_eliminated[x] = true;
+            n_merged_variables ++;
+            for (unsigned int s=0; s<2; s++)
+            {
+                std::vector<unsigned int> & occ =
+                    occurrences[lit_index((s == 0) ? x : no(x))];
+                for (unsigned int k=0; k<occ.size(); k++)
+                    if (!to_rewrite[occ[k]])
+                    {
+                        to_rewrite[occ[k]] = true;
+                        rewritten.push_back(occ[k]);
+                    }
+            }
+        }
+
+    std::vector<long int> units;
+    for (unsigned int k=0; k<rewritten.size(); k++)
+    {
+        std::vector<long int> c = clauses[rewritten[k]];
+        remove_clause(rewritten[k]);
+        for (unsigned int j=0; j<c.size(); j++)
+        {
+            long int x = (c[j] > 0) ? c[j] : (-1)*c[j];
+            if (substitute[x] != 0)
+                c[j] = (c[j] > 0) ? substitute[x] : no(substitute[x]);
+        }
+        std::sort(c.begin(), c.end(), literal_order);
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        bool tautology = false;
+        for (unsigned int j=1; j<c.size() && !tautology; j++)
+            tautology = (c[j] == no(c[j-1]));
+        if (tautology)
+            continue;
+        if (c.size() == 1)
+            units.push_back(c[0]);
+        // The clause is replaced rather than removed.
+        add(c);
+        n_removed_clauses --;
+    }
+    for (unsigned int k=0; k<units.size() && !unsat; k++)
+        fix(units[k]);
+}
+
+
+/** Used to sort clauses so that identical ones are adjacent. */
+struct ClauseOrder
+{
+    const std::vector<std::vector<long int> > * clauses;
+    bool operator()(unsigned int i, unsigned int j) const
+    {
+        return (*clauses)[i] < (*clauses)[j];
+    }
+};
+
+
+void Preprocessor::remove_duplicates()
+{
+    std::vector<unsigned int> order;
+    for (unsigned int i=0; i<clauses.size(); i++)
+        if (!removed[i])
+            order.push_back(i);
+    ClauseOrder cmp;
+    cmp.clauses = &clauses;
+    std::sort(order.begin(), order.end(), cmp);
+    for (unsigned int k=1; k<order.size() && !out_of_time(); k++)
+        if (clauses[order[k]] == clauses[order[k-1]])
+            remove_clause(order[k]);
+}
+
+
+void Preprocessor::subsume()
+{
+    std::vector<std::pair<unsigned int, unsigned int> > by_size;
+    for (unsigned int i=0; i<clauses.size(); i++)
+        if (!removed[i])
+            by_size.push_back(std::make_pair(clauses[i].size(), i));
+    std::sort(by_size.begin(), by_size.end());
+    subsumption_queue.clear();
+    for (unsigned int k=by_size.size(); k>0; k--)
+        subsumption_queue.push_back(by_size[k-1].second);
+
+    while (!subsumption_queue.empty() && !unsat && !out_of_time())
+    {
+        unsigned int i = subsumption_queue.back();
+        subsumption_queue.pop_back();
+        subsume_with(i);
+    }
+    subsumption_queue.clear();
+}
+
+
+void Preprocessor::subsume_with(unsigned int i)
+{
+    if (removed[i])
+        return;
+    std::vector<long int> c = clauses[i];
+    long int best = c[0];
+    for (unsigned int j=0; j<c.size(); j++)
+    {
+        marks[lit_index(c[j])] = true;
+        if (occurrences[lit_index(c[j])].size()
+            + occurrences[lit_index(no(c[j]))].size()
+            < occurrences[lit_index(best)].size()
+            + occurrences[lit_index(no(best))].size())
+            best = c[j];
+    }
+
+    std::vector<unsigned int> candidates = occurrences[lit_index(best)];
+    candidates.insert(candidates.end(),
+                      occurrences[lit_index(no(best))].begin(),
+                      occurrences[lit_index(no(best))].end());
+    std::vector<unsigned int> new_units;
+    for (unsigned int k=0; k<candidates.size(); k++)
+    {
+        unsigned int d = candidates[k];
+        if (d == i || removed[d] || clauses[d].size() < c.size())
+            continue;
+        unsigned int hits = 0, flips = 0;
+        long int flipped = 0;
+        for (unsigned int j=0; j<clauses[d].size(); j++)
+            if (marks[lit_index(clauses[d][j])])
+                hits ++;
+            else if (marks[lit_index(no(clauses[d][j]))])
+            {
+                flips ++;
+                flipped = clauses[d][j];
+            }
+        if (hits + flips < c.size() || flips > 1)
+            continue;
+        else if (flips == 0)
+            remove_clause(d);
+        else
+        {
+            remove_literal(d, flipped);
+            if (clauses[d].size() == 1)
+                new_units.push_back(d);
+        }
+    }
+
+    for (unsigned int j=0; j<c.size(); j++)
+        marks[lit_index(c[j])] = false;
+    for (unsigned int k=0; k<new_units.size() && !unsat; k++)
+        if (!removed[new_units[k]])
+            fix(clauses[new_units[k]][0]);
+}
+
+
+void Preprocessor::probe()
+{
+    for (long int x=1; x<(long int)assignment.size() && !unsat; x++)
+    {
+        if (out_of_time())
+            return;
+        if (assignment[x] != 0
+            || occurrences[lit_index(x)].empty()
+            || occurrences[lit_index(no(x))].empty())
+            continue;
+
+        unsigned int start = trail.size();
+        assign(x);
+        if (!propagate(start))
+        {
+            backtrack(start);
+            fix(no(x));
+            continue;
+        }
+        std::vector<long int> implied(trail.begin() + start + 1, trail.end());
+        backtrack(start);
+
+        assign(no(x));
+        if (!propagate(start))
+        {
+            backtrack(start);
+            fix(x);
+            continue;
+        }
+        // Literals implied by both x and no(x) are true.
+        for (unsigned int k=0; k<implied.size(); k++)
+            marks[lit_index(implied[k])] = true;
+        std::vector<long int> common;
+        for (unsigned int k=start+1; k<trail.size(); k++)
+            if (marks[lit_index(trail[k])])
+                common.push_back(trail[k]);
+        for (unsigned int k=0; k<implied.size(); k++)
+            marks[lit_index(implied[k])] = false;
+        backtrack(start);
+        for (unsigned int k=0; k<common.size() && !unsat; k++)
+            fix(common[k]);
+    }
+}
+
+
+void Preprocessor::eliminate()
+{
+    std::vector<std::pair<unsigned int, long int> > candidates;
+    for (long int x=1; x<(long int)assignment.size(); x++)
+        if (!is_frozen[x])
+            candidates.push_back(std::make_pair(
+                                     occurrences[lit_index(x)].size()
+                                     + occurrences[lit_index(no(x))].size(),
+                                     x));
+    std::sort(candidates.begin(), candidates.end());
+
+    for (unsigned int k=0; k<candidates.size() && !unsat; k++)
+    {
+        if (out_of_time())
+            return;
+        long int x = candidates[k].second;
+        if (assignment[x] == 0 && !is_eliminated[x])
+            eliminate_variable(x);
+    }
+}
+
+
+/** Stores in r the resolvent of the sorted clauses c1 and c2 on the
+ * variable x. Returns false if it is a tautology. */
+static bool resolve(const std::vector<long int> & c1,
+                    const std::vector<long int> & c2,
+                    long int x,
+                    std::vector<long int> & r)
+{
+    r.clear();
+    unsigned int i = 0, j = 0;
+    while (i < c1.size() || j < c2.size())
+    {
+        long int l;
+        if (j == c2.size() || (i < c1.size() && literal_order(c1[i], c2[j])))
+            l = c1[i++];
+        else if (i == c1.size() || literal_order(c2[j], c1[i]))
+            l = c2[j++];
+        else
+        {
+            l = c1[i++];
+            j++;
+        }
+        if (l == x || l == no(x))
+            continue;
+        else if (!r.empty() && r.back() == no(l))
+            return false;
+        r.push_back(l);
+    }
+    return true;
+}
+
+
+bool Preprocessor::eliminate_variable(long int x)
+{
+    std::vector<unsigned int>
+        pos = occurrences[lit_index(x)],
+        neg = occurrences[lit_index(no(x))];
+    if (pos.empty() && neg.empty())
+        return false;
+    if (pos.size() + neg.size() > elimination_occurrence_limit)
+        return false;
+
+    std::vector<std::vector<long int> > resolvents;
+    std::vector<long int> r;
+    for (unsigned int i=0; i<pos.size(); i++)
+        for (unsigned int j=0; j<neg.size(); j++)
+            if (resolve(clauses[pos[i]], clauses[neg[j]], x, r))
+            {
+                if (r.size() > elimination_clause_limit
+                    || resolvents.size() == pos.size() + neg.size())
+                    return false;
+                resolvents.push_back(r);
+            }
+
+    // The clauses of the smallest side are enough to rebuild the
+    // value of x, the other polarity being the default.
+    std::vector<unsigned int> & kept = (pos.size() > neg.size()) ? neg : pos;
+    long int pivot = (pos.size() > neg.size()) ? no(x) : x;
+    for (unsigned int i=0; i<kept.size(); i++)
+    {
+        Clause c{pivot};
+        for (unsigned int j=0; j<clauses[kept[i]].size(); j++)
+            if (clauses[kept[i]][j] != pivot)
+                c.push_back(clauses[kept[i]][j]);
+        f->reconstruction_stack.push_back(c);
+    }
+    f->reconstruction_stack.push_back(Clause{no(pivot)});
+
+    for (unsigned int i=0; i<pos.size(); i++)
+        remove_clause(pos[i]);
+    for (unsigned int i=0; i<neg.size(); i++)
+        remove_clause(neg[i]);
+    is_eliminated[x] = true;
+    n_eliminated_variables ++;
+
+    std::vector<long int> units;
+    for (unsigned int i=0; i<resolvents.size(); i++)
+    {
+        if (resolvents[i].empty())
+            unsat = true;
+        else if (resolvents[i].size() == 1)
+            units.push_back(resolvents[i][0]);
+        add(resolvents[i]);
+    }
+    for (unsigned int i=0; i<units.size() && !unsat; i++)
+        fix(units[i]);
+    return true;
+}
+
+
+// !SECTION! Retrieving data
+// =========================
+
+void Preprocessor::print_statistics()
+{
+    std::cout << "removed clauses:      " << n_removed_clauses << std::endl
+              << "removed literals:     " << n_removed_literals << std::endl
+              << "fixed variables:      " << n_fixed_variables << std::endl
+              << "eliminated variables: " << n_eliminated_variables
+              << std::endl
+              << "merged variables:     " << n_merged_variables
+              << std::endl;
+}
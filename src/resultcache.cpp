@@ -0,0 +1,294 @@
+/**
+ * @name resultcache.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 18:22:05 leo>
+ *
+ * @brief Source code of the ResultCache class.
+ */
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+
+/** The first bytes of a cache file. */
+static const char CACHE_MAGIC[8] = {'L', 'C', 'N', 'F', 'R', 'C', '0', '2'};
+
+
+/** The size of the fixed part of the content of a record: the key,
+ * the status and the number of literals. */
+static const uint32_t RECORD_HEADER_SIZE = 8 + 8 + 1 + 4;
+
+
+/** The finalizer of splitmix64, used to mix the literals. */
+static uint64_t mix(uint64_t x)
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+
+/** Hashes a sorted list of literals with two different seeds. */
+static void hash_literals(const std::vector<long int> & lits,
+                          uint64_t & low, uint64_t & high)
+{
+    low = 0x243f6a8885a308d3ULL;
+    high = 0x13198a2e03707344ULL;
+    for (unsigned int i=0; i<lits.size(); i++)
+    {
+        low = mix(low ^ (uint64_t)lits[i]);
+        high = mix(high + (uint64_t)lits[i] * 0x9e3779b97f4a7c15ULL);
+    }
+    low = mix(low ^ lits.size());
+    high = mix(high ^ (lits.size() << 1));
+}
+
+
+/** Returns the checksum of n bytes, which ends each record. */
+static uint64_t checksum(const char * p, std::size_t n)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    for (std::size_t i=0; i<n; i++)
+        h = (h ^ (unsigned char)p[i]) * 0x100000001b3ULL;
+    return mix(h ^ n);
+}
+
+
+/** Copies the bytes starting at p into x and returns the position
+ * following them. */
+template <typename T>
+static const char * load(const char * p, T & x)
+{
+    memcpy(&x, p, sizeof(T));
+    return p + sizeof(T);
+}
+
+
+/** Copies x at p and returns the position following it. */
+template <typename T>
+static char * save(char * p, const T & x)
+{
+    memcpy(p, &x, sizeof(T));
+    return p + sizeof(T);
+}
+
+
+// !SECTION! Opening the cache
+// ===========================
+
+ResultCache::ResultCache()
+{
+    n_hits = 0;
+    n_misses = 0;
+}
+
+
+ResultCache::ResultCache(std::string _path)
+{
+    n_hits = 0;
+    n_misses = 0;
+    path = _path;
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd != -1)
+    {
+        bool written = (write(fd, CACHE_MAGIC, sizeof(CACHE_MAGIC))
+                        == (ssize_t)sizeof(CACHE_MAGIC));
+        close(fd);
+        if (!written)
+            throw std::runtime_error("Cannot write " + path + ".");
+        return;
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        throw std::runtime_error("Cannot open " + path + ".");
+    char magic[sizeof(CACHE_MAGIC)];
+    if (!in.read(magic, sizeof(magic))
+        || !std::equal(magic, magic+sizeof(magic), CACHE_MAGIC))
+        throw std::runtime_error("Not a result cache file: " + path);
+
+    // Each record is: the size of its content on 4 bytes, the
+    // content (the key, the status on a byte, the number of literals
+    // on 4 bytes and the literals on 8 bytes each) and its checksum
+    // on 8 bytes. The records are read up to the first invalid one,
+    // e.g. cut by a crash, and the file is truncated there.
+    std::streamoff valid_end = sizeof(CACHE_MAGIC);
+    std::vector<char> content;
+    while (true)
+    {
+        uint32_t size;
+        uint64_t sum;
+        if (!in.read((char*)&size, 4) || size < RECORD_HEADER_SIZE
+            || (size - RECORD_HEADER_SIZE) % 8 != 0)
+            break;
+        content.resize(size);
+        if (!in.read(content.data(), size) || !in.read((char*)&sum, 8)
+            || sum != checksum(content.data(), size))
+            break;
+        Key k;
+        unsigned char status;
+        uint32_t n;
+        const char * p = content.data();
+        p = load(load(load(load(p, k.low), k.high), status), n);
+        if (status > 1 || n != (size - RECORD_HEADER_SIZE) / 8)
+            break;
+        Entry e;
+        e.status = (status == 1) ? SATISFIABLE : UNSATISFIABLE;
+        e.literals.resize(n);
+        for (uint32_t i=0; i<n; i++)
+        {
+            int64_t x;
+            p = load(p, x);
+            e.literals[i] = x;
+        }
+        entries[k] = e;
+        valid_end = in.tellg();
+    }
+    in.close();
+
+    struct stat file_status;
+    if (stat(path.c_str(), &file_status) == 0 && file_status.st_size > valid_end
+        && truncate(path.c_str(), valid_end) == -1)
+        throw std::runtime_error("Cannot truncate " + path + ".");
+}
+
+
+// !SECTION! Hashing the queries
+// =============================
+
+ResultCache::Key ResultCache::hash(const Formula & f,
+                                   std::vector<long int> assumptions)
+{
+    VariableSet * v = f.variables();
+    // The hashes of the clauses are added so that their order does
+    // not matter.
+    Key k = {0, 0};
+    std::vector<long int> c;
+    for (unsigned long int i=0; i<f.size(); i++)
+    {
+        c.clear();
+        for (const Lit * l=f.clause_begin(i); l!=f.clause_end(i); l++)
+            c.push_back(v->new_code(*l).code());
+        std::sort(c.begin(), c.end());
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+        uint64_t low, high;
+        hash_literals(c, low, high);
+        k.low += low;
+        k.high += high;
+    }
+    for (unsigned int i=0; i<assumptions.size(); i++)
+        assumptions[i] = v->new_code(assumptions[i]);
+    std::sort(assumptions.begin(), assumptions.end());
+    assumptions.erase(std::unique(assumptions.begin(), assumptions.end()),
+                      assumptions.end());
+    uint64_t low, high;
+    hash_literals(assumptions, low, high);
+    k.low = mix(k.low ^ mix(low) ^ f.size());
+    k.high = mix(k.high + high + (f.size() << 1));
+    return k;
+}
+
+
+// !SECTION! Using the answers
+// ===========================
+
+ResultCache::Status ResultCache::lookup(const Key & k,
+                                        VariableSet * v,
+                                        std::vector<long int> * core) const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    auto it = entries.find(k);
+    if (it == entries.end())
+    {
+        n_misses ++;
+        return UNKNOWN;
+    }
+    n_hits ++;
+    const Entry & e = it->second;
+    if (e.status == SATISFIABLE)
+    {
+        v->clear_assignment();
+        for (unsigned long int i=0; i<e.literals.size(); i++)
+            if ((unsigned long int)e.literals[i] <= v->size())
+                v->set_literal(e.literals[i]);
+        // The variables may be renamed differently than when the
+        // model was stored.
+        v->propagate_equalities();
+    }
+    else if (core != NULL)
+        *core = e.literals;
+    return e.status;
+}
+
+
+void ResultCache::store(const Key & k, const Entry & e)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    entries[k] = e;
+    if (path.empty())
+        return;
+    uint32_t n = e.literals.size(), size = RECORD_HEADER_SIZE + 8*n;
+    std::vector<char> record(4 + size + 8);
+    unsigned char status = (e.status == SATISFIABLE) ? 1 : 0;
+    char * p = save(record.data(), size);
+    p = save(save(save(save(p, k.low), k.high), status), n);
+    for (uint32_t i=0; i<n; i++)
+        p = save(p, (int64_t)e.literals[i]);
+    save(p, checksum(record.data() + 4, size));
+
+    // A single write in append mode so that the records of several
+    // processes sharing the file are not interleaved.
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+    if (fd == -1)
+        throw std::runtime_error("Cannot open " + path + ".");
+    ssize_t written = write(fd, record.data(), record.size());
+    close(fd);
+    if (written != (ssize_t)record.size())
+        throw std::runtime_error("Cannot write " + path + ".");
+}
+
+
+void ResultCache::store_satisfiable(const Key & k, const VariableSet & v)
+{
+    Entry e;
+    e.status = SATISFIABLE;
+    std::vector<long int> assignment = v.assignment();
+    for (unsigned long int i=0; i<assignment.size(); i++)
+        if (assignment[i] > 0)
+            e.literals.push_back(assignment[i]);
+    store(k, e);
+}
+
+
+void ResultCache::store_unsatisfiable(const Key & k, std::vector<long int> core)
+{
+    Entry e;
+    e.status = UNSATISFIABLE;
+    e.literals = core;
+    store(k, e);
+}
+
+
+unsigned long int ResultCache::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+
+void ResultCache::print_statistics() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    std::cout << "stored queries: " << entries.size() << std::endl
+              << "hits: " << n_hits << std::endl
+              << "misses: " << n_misses << std::endl;
+}
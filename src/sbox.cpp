@@ -133,6 +133,7 @@ void Sbox::add_clauses_image(
     std::vector<long int> input_bits,
     std::vector<long int> output_bits)
 {
+    LIBCNF_SOURCE(SBOX);
     if (input_bits.size() != n_input_bits)
         throw std::runtime_error("In Sbox.add_clauses_image: the input bit"
                                  " vector is not of the correct size.");
@@ -0,0 +1,363 @@
+/**
+ * @name snapshot.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 19:04:41 leo>
+ *
+ * @brief Source code of the Snapshot class.
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+static_assert(sizeof(long int) == 8 && sizeof(unsigned long int) == 8,
+              "Snapshots assume 64-bit long integers.");
+static_assert(sizeof(Lit) == 4, "Snapshots assume 32-bit literals.");
+
+const uint32_t Snapshot::VERSION;
+const unsigned int Snapshot::HEADER_WORDS;
+
+
+/** The first bytes of a snapshot. */
+static const char SNAPSHOT_MAGIC[8] = {'L', 'C', 'N', 'F', 'S', 'N', 'A', 'P'};
+
+
+// !SECTION! Checksum
+// ==================
+
+/** Updates the checksum h with the words in [begin, end). */
+static uint64_t checksum(uint64_t h, const uint64_t * begin, const uint64_t * end)
+{
+    for (const uint64_t * w = begin; w != end; w++)
+    {
+        h = ((h << 27) | (h >> 37)) ^ *w;
+        h *= 0x9e3779b97f4a7c15ULL;
+    }
+    return h ^ (h >> 32);
+}
+
+
+/** The initial value of the checksum. */
+static const uint64_t CHECKSUM_SEED = 0xcbf29ce484222325ULL;
+
+
+// !SECTION! Writing
+// =================
+
+/** Buffers the words written to a snapshot and computes their
+ * checksum. */
+class SnapshotWriter
+{
+private:
+    std::ofstream out;
+    std::vector<uint64_t> buffer;
+    uint64_t h;
+    unsigned long int n_bytes;
+    uint64_t pair;
+    unsigned int n_halves;
+
+public:
+    SnapshotWriter(const std::string & path)
+        : out(path.c_str(), std::ios::binary | std::ios::trunc),
+          h(CHECKSUM_SEED),
+          n_bytes(Snapshot::HEADER_WORDS*8),
+          pair(0),
+          n_halves(0)
+    {
+        if (!out)
+            throw std::runtime_error("Cannot open " + path + ".");
+        // The header is written once the checksum is known.
+        std::vector<char> blank(Snapshot::HEADER_WORDS*8, 0);
+        out.write(blank.data(), blank.size());
+        buffer.reserve(1 << 16);
+    }
+
+    void word(uint64_t w)
+    {
+        buffer.push_back(w);
+        if (buffer.size() == buffer.capacity())
+            flush();
+    }
+
+    /** Writes the literals given one after the other as they are in
+     * memory, two per word; lits_end() must be called after the last
+     * one. */
+    void lit(Lit l)
+    {
+        std::memcpy(reinterpret_cast<char *>(&pair) + n_halves*sizeof(Lit),
+                    &l, sizeof(Lit));
+        n_halves ++;
+        if (n_halves == 2)
+            lits_end();
+    }
+
+    void lits_end()
+    {
+        if (n_halves > 0)
+            word(pair);
+        pair = 0;
+        n_halves = 0;
+    }
+
+    void text(const std::string & s)
+    {
+        for (unsigned int i=0; i<s.size(); i+=8)
+        {
+            uint64_t w = 0;
+            std::memcpy(&w, s.data() + i, std::min<std::size_t>(8, s.size() - i));
+            word(w);
+        }
+    }
+
+    void flush()
+    {
+        h = checksum(h, buffer.data(), buffer.data() + buffer.size());
+        out.write(reinterpret_cast<const char *>(buffer.data()),
+                  buffer.size()*8);
+        n_bytes += buffer.size()*8;
+        buffer.clear();
+    }
+
+    /** Writes the header and closes the file; returns false if
+     * something went wrong. */
+    bool finish(std::vector<uint64_t> header)
+    {
+        flush();
+        header[2] = h;
+        header[3] = n_bytes;
+        out.seekp(0);
+        out.write(reinterpret_cast<const char *>(header.data()),
+                  header.size()*8);
+        out.close();
+        return !out.fail();
+    }
+};
+
+
+void Snapshot::save(const Formula & f, const std::string & path)
+{
+    const VariableSet * v = f.v;
+    std::vector<std::string> names(v->subset_dimensions.size());
+    for (auto it = v->subset_indices.begin(); it != v->subset_indices.end(); it++)
+        names[it->second] = it->first;
+    unsigned long int n_literals = 0, n_reconstruction_literals = 0;
+    for (unsigned long int i=0; i<f.size(); i++)
+        n_literals += f.clause_end(i) - f.clause_begin(i);
+    for (unsigned long int i=0; i<f.reconstruction_stack.size(); i++)
+        n_reconstruction_literals += f.reconstruction_stack[i].size();
+
+    std::vector<uint64_t> header(HEADER_WORDS, 0);
+    std::memcpy(&header[0], SNAPSHOT_MAGIC, 8);
+    header[1] = (uint64_t)VERSION | ((uint64_t)8 << 32);
+    header[4] = names.size();
+    header[5] = v->n_renamed;
+    header[6] = f.size();
+    header[7] = n_literals;
+    header[8] = f.reconstruction_stack.size();
+    header[9] = n_reconstruction_literals;
+
+    std::string tmp_path = path + ".tmp";
+    {
+        SnapshotWriter w(tmp_path);
+        for (unsigned int s=0; s<names.size(); s++)
+        {
+            w.word(names[s].size());
+            w.word(v->subset_dimensions[s].size());
+            w.text(names[s]);
+            for (unsigned int d=0; d<v->subset_dimensions[s].size(); d++)
+                w.word(v->subset_dimensions[s][d]);
+        }
+        for (unsigned int s=0; s<v->subset_cumulated_sizes.size(); s++)
+            w.word(v->subset_cumulated_sizes[s]);
+        for (unsigned long int x=0; x<v->equalities.size(); x++)
+            if (v->equalities[x] != Lit())
+            {
+                w.word(x);
+                w.word(v->equalities[x].index());
+            }
+
+        unsigned long int start = 0;
+        w.word(start);
+        for (unsigned long int i=0; i<f.reconstruction_stack.size(); i++)
+        {
+            start += f.reconstruction_stack[i].size();
+            w.word(start);
+        }
+        for (unsigned long int i=0; i<f.reconstruction_stack.size(); i++)
+            for (unsigned int j=0; j<f.reconstruction_stack[i].size(); j++)
+                w.word(f.reconstruction_stack[i][j]);
+
+        start = 0;
+        w.word(start);
+        for (unsigned long int i=0; i<f.size(); i++)
+        {
+            start += f.clause_end(i) - f.clause_begin(i);
+            w.word(start);
+        }
+        // The literals are used in place once the file is mapped.
+        for (unsigned long int i=0; i<f.size(); i++)
+            for (const Lit * l = f.clause_begin(i); l != f.clause_end(i); l++)
+                w.lit(*l);
+        w.lits_end();
+
+        if (!w.finish(header))
+            throw std::runtime_error("Cannot write " + tmp_path + ".");
+    }
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("Cannot rename " + tmp_path + " into " + path + ".");
+}
+
+
+// !SECTION! Loading
+// =================
+
+/** Reads the words of a mapped snapshot one after the other, making
+ * sure it does not go past its end. */
+class SnapshotReader
+{
+private:
+    const uint64_t * position;
+    const uint64_t * end;
+    std::string path;
+
+public:
+    SnapshotReader(const uint64_t * begin, const uint64_t * _end,
+                   const std::string & _path)
+        : position(begin), end(_end), path(_path) {}
+
+    /** Returns the n next words and skips them. */
+    const uint64_t * words(uint64_t n)
+    {
+        if (n > (uint64_t)(end - position))
+            throw std::runtime_error(path + " is truncated.");
+        const uint64_t * result = position;
+        position += n;
+        return result;
+    }
+
+    uint64_t word()
+    {
+        return *words(1);
+    }
+
+    std::string text(uint64_t length)
+    {
+        const char * s = reinterpret_cast<const char *>(words((length + 7) / 8));
+        return std::string(s, length);
+    }
+
+    bool at_end() const
+    {
+        return position == end;
+    }
+};
+
+
+void Snapshot::load(const std::string & path, Formula * f, bool verify)
+{
+    VariableSet * v = f->v;
+    if (f->size() != 0 || !f->reconstruction_stack.empty())
+        throw std::logic_error("A snapshot must be loaded in an empty formula.");
+    if (!v->subset_dimensions.empty() || v->n_renamed != 0)
+        throw std::logic_error("A snapshot must be loaded in an empty VariableSet.");
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Cannot open " + path + ".");
+    struct stat status;
+    if (fstat(fd, &status) == -1)
+    {
+        close(fd);
+        throw std::runtime_error("Cannot read " + path + ".");
+    }
+    std::size_t n_bytes = status.st_size;
+    if (n_bytes < HEADER_WORDS*8 || n_bytes % 8 != 0)
+    {
+        close(fd);
+        throw std::runtime_error(path + " is not a snapshot.");
+    }
+    // The mapping is shared so that all the processes loading the
+    // same snapshot use the same pages.
+    void * data = mmap(NULL, n_bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw std::runtime_error("Cannot map " + path + " in memory.");
+    std::shared_ptr<const void> mapping(
+        data,
+        [n_bytes](const void * p) { munmap(const_cast<void *>(p), n_bytes); });
+
+    const uint64_t * words = static_cast<const uint64_t *>(data);
+    const uint64_t * end = words + n_bytes/8;
+    if (std::memcmp(words, SNAPSHOT_MAGIC, 8) != 0)
+        throw std::runtime_error(path + " is not a snapshot.");
+    if ((words[1] & 0xffffffff) != VERSION || (words[1] >> 32) != 8)
+        throw std::runtime_error(path + " was written by another version of libcnf.");
+    if (words[3] != n_bytes)
+        throw std::runtime_error(path + " is truncated.");
+    if (verify && checksum(CHECKSUM_SEED, words + HEADER_WORDS, end) != words[2])
+        throw std::runtime_error(path + " is corrupted (wrong checksum).");
+
+    SnapshotReader r(words + HEADER_WORDS, end, path);
+    VariableSet loaded;
+    for (uint64_t s=0; s<words[4]; s++)
+    {
+        uint64_t name_length = r.word(), n_dims = r.word();
+        std::string name = r.text(name_length);
+        const uint64_t * dims = r.words(n_dims);
+        std::vector<unsigned int> subset_dim(dims, dims + n_dims);
+        loaded.subset_indices[name] = s;
+        loaded.subset_dimensions.push_back(subset_dim);
+    }
+    const uint64_t * cumulated = r.words(words[4] + 1);
+    loaded.subset_cumulated_sizes.assign(cumulated, cumulated + words[4] + 1);
+    for (uint64_t s=0; s<words[4]; s++)
+        loaded.subset_handles.push_back(
+            Subset(loaded.subset_cumulated_sizes[s] + 1,
+                   loaded.subset_dimensions[s]));
+    for (uint64_t e=0; e<words[5]; e++)
+    {
+        const uint64_t * pair = r.words(2);
+        if (pair[0] == 0 || pair[0] > Var::MAX_CODE || pair[1] == 0)
+            throw std::runtime_error(path + " is corrupted.");
+        if (pair[0] >= loaded.equalities.size())
+            loaded.equalities.resize(pair[0] + 1);
+        loaded.equalities[pair[0]] = Lit::from_index(pair[1]);
+    }
+    loaded.n_renamed = words[5];
+
+    const uint64_t * stack_starts = r.words(words[8] + 1);
+    const long int * stack_literals =
+        reinterpret_cast<const long int *>(r.words(words[9]));
+    std::vector<Clause> stack;
+    for (uint64_t i=0; i<words[8]; i++)
+    {
+        if (stack_starts[i] > stack_starts[i+1] || stack_starts[i+1] > words[9])
+            throw std::runtime_error(path + " is corrupted.");
+        stack.push_back(Clause(std::vector<long int>(
+                                   stack_literals + stack_starts[i],
+                                   stack_literals + stack_starts[i+1])));
+    }
+
+    const unsigned long int * starts =
+        reinterpret_cast<const unsigned long int *>(r.words(words[6] + 1));
+    const Lit * literals =
+        reinterpret_cast<const Lit *>(r.words((words[7] + 1) / 2));
+    if (!r.at_end() || starts[0] != 0 || starts[words[6]] != words[7])
+        throw std::runtime_error(path + " is corrupted.");
+
+    // Only the small tables are copied; the clauses stay in the file.
+    v->subset_indices.swap(loaded.subset_indices);
+    v->subset_dimensions.swap(loaded.subset_dimensions);
+    v->subset_cumulated_sizes.swap(loaded.subset_cumulated_sizes);
+    v->subset_handles.swap(loaded.subset_handles);
+    v->equalities.swap(loaded.equalities);
+    std::swap(v->n_renamed, loaded.n_renamed);
+    f->reconstruction_stack.swap(stack);
+    if (words[6] > 0)
+        f->add_segment(literals, starts, words[6], mapping);
+}
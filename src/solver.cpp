@@ -6,42 +6,156 @@
  * @brief The source code of the Solver class.
  */
 
+#include <sys/wait.h>
+
 #include "../include/libcnf.hpp"
 
 using namespace cnf;
 
 
+/** Returns true if the output of the SAT-solver in the given file
+ * states that the formula is unsatisfiable, as opposed to the solver
+ * giving up. */
+static bool states_unsat(std::string path)
+{
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+        if (line.compare(0, 5, "UNSAT") == 0
+            || line.compare(0, 15, "s UNSATISFIABLE") == 0)
+            return true;
+    return false;
+}
+
+
 Solver::Solver(std::string solverName,
                std::initializer_list<std::string> options)
 {
-    std::stringstream input, output;
+    std::stringstream input, output, phase;
     input << solverName << "-in-" << time(NULL) << ".dim";
     output << solverName << "-out-" << time(NULL) << ".dim";
+    phase << solverName << "-phase-" << time(NULL) << ".dim";
     inputName  = input.str();
     outputName = output.str();
+    phaseName  = phase.str();
     command = solverName;
+    model_on_stdout = false;
+    cache = NULL;
     for (auto opt = options.begin(); opt != options.end(); opt ++)
         command += " " + (*opt);
 }
 
 
+void Solver::set_model_on_stdout(bool enable)
+{
+    model_on_stdout = enable;
+}
+
+
+void Solver::set_phase_hints(std::vector<long int> lits, std::string option)
+{
+    phase_hints = lits;
+    phase_option = option;
+}
+
+
+void Solver::set_cache(ResultCache * _cache)
+{
+    cache = _cache;
+}
+
+
+void Solver::set_compression(Compression::Codec codec)
+{
+    if (!Compression::available(codec))
+        throw std::runtime_error(
+            "libcnf was built without support for the "
+            + Compression::extension(codec) + " files.");
+    inputName = inputName.substr(0, inputName.rfind(".dim") + 4)
+        + Compression::extension(codec);
+}
+
+
 bool Solver::solve(Formula f, VariableSet * v)
 {
-    std::ofstream dimacsInput;
-    dimacsInput.open(inputName);
-    f.to_dimacs(&dimacsInput, v->size());
+    return solve(&f, v);
+}
+
+
+bool Solver::solve(Formula * f, VariableSet * v)
+{
+    ResultCache::Key key;
+    if (cache != NULL)
+    {
+        key = ResultCache::hash(*f);
+        ResultCache::Status known = cache->lookup(key, v);
+        // The model may have been found for another formula
+        // preprocessed into the same clauses.
+        if (known == ResultCache::SATISFIABLE)
+            f->extend_model();
+        if (known != ResultCache::UNKNOWN)
+            return known == ResultCache::SATISFIABLE;
+    }
 
-    std::string fullCommand =
-        command + " " + inputName + " " +
-        outputName + " 2>/dev/null 1>/dev/null";
+    DimacsNumbering numbering = f->to_dimacs_file(inputName);
 
-    if (system(fullCommand.c_str()) == -1)
+    std::string fullCommand = command;
+    if (!phase_hints.empty())
+    {
+        // The hints must use the numbering of the DIMACS file.
+        std::unordered_map<long int, long int> dimacs_index;
+        for (unsigned long int i=1; i<=numbering.size(); i++)
+            dimacs_index[numbering.code(i)] = i;
+        std::ofstream phaseFile(phaseName);
+        phaseFile << "v";
+        for (unsigned long int i=0; i<phase_hints.size(); i++)
+        {
+            long int l = v->new_code(phase_hints[i]);
+            auto it = dimacs_index.find((l > 0) ? l : (-1)*l);
+            if (numbering.is_identity())
+                phaseFile << " " << l;
+            else if (it != dimacs_index.end())
+                phaseFile << " " << ((l > 0) ? it->second : (-1)*it->second);
+        }
+        phaseFile << " 0" << std::endl;
+        fullCommand += " " + phase_option + phaseName;
+    }
+    fullCommand += " " + inputName;
+    if (model_on_stdout)
+        fullCommand += " 2>/dev/null 1>" + outputName;
+    else
+        fullCommand += " " + outputName + " 2>/dev/null 1>/dev/null";
+
+    // The output of a previous run must not be taken for this one.
+    std::remove(outputName.c_str());
+    int status;
+    {
+        LIBCNF_TIMER(SPAWN);
+        status = system(fullCommand.c_str());
+    }
+    if (status == -1 || !WIFEXITED(status))
+        throw std::runtime_error(
+            "The SAT-solver did not run correctly.");
+    // By convention, SAT-solvers exit with 10 if the formula is
+    // satisfiable and 20 if it is not; only these answers are cached.
+    int code = WEXITSTATUS(status);
+    if (code == 127)
+        throw std::runtime_error(
+            "The SAT-solver could not be started: " + command);
+    if (code > 128)
         throw std::runtime_error(
-            "The SAT-solver did not run correcly.");
+            "The SAT-solver was killed: " + command);
 
-    std::ifstream dimacsOutput;
-    dimacsOutput.open(outputName);
-    return v->parse_dimacs(&dimacsOutput);
+    if (!v->parse_dimacs_file(outputName, numbering))
+    {
+        if (cache != NULL && code == 20 && states_unsat(outputName))
+            cache->store_unsatisfiable(key);
+        return false;
+    }
+    f->extend_model();
+    if (cache != NULL && code == 10)
+        cache->store_satisfiable(key, *v);
+    return true;
 }
 
 
@@ -0,0 +1,167 @@
+/**
+ * @name statistics.cpp
+ * @author Leo "picarresursix" Perrin <leoperrin@picarresursix.fr>
+ * @date Time-stamp: <2026-10-18 20:52:19 leo>
+ *
+ * @brief Source code of the Statistics class.
+ */
+
+#include "../include/libcnf.hpp"
+
+using namespace cnf;
+
+const unsigned int Statistics::MAX_LENGTH;
+
+thread_local Statistics::Source Statistics::current_source = Statistics::USER;
+
+
+static const char * SOURCE_NAMES[Statistics::N_SOURCES] = {
+    "user", "sbox", "xor", "equality", "template", "internal"};
+
+static const char * PHASE_NAMES[Statistics::N_PHASES] = {
+    "export", "spawn", "parse", "solve", "preprocess"};
+
+static const char * FOOTPRINT_NAMES[Statistics::N_FOOTPRINTS] = {
+    "formula", "variable_set"};
+
+
+// !SECTION! Scopes
+// ================
+
+Statistics::SourceScope::SourceScope(Source s)
+{
+    previous = current_source;
+    current_source = s;
+}
+
+
+Statistics::SourceScope::~SourceScope()
+{
+    current_source = previous;
+}
+
+
+Statistics::ScopedTimer::ScopedTimer(Phase p)
+    : phase(p), start(std::chrono::steady_clock::now())
+{
+}
+
+
+Statistics::ScopedTimer::~ScopedTimer()
+{
+    Statistics::global().count_phase(
+        phase, std::chrono::steady_clock::now() - start);
+}
+
+
+// !SECTION! Counting
+// ==================
+
+Statistics::Statistics()
+{
+    reset();
+}
+
+
+Statistics & Statistics::global()
+{
+    static Statistics stats;
+    return stats;
+}
+
+
+void Statistics::count_clause(unsigned long int length)
+{
+    n_clauses[current_source].fetch_add(1, std::memory_order_relaxed);
+    n_literals[current_source].fetch_add(length, std::memory_order_relaxed);
+    lengths[std::min<unsigned long int>(length, MAX_LENGTH)].fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+
+void Statistics::count_phase(Phase p, std::chrono::steady_clock::duration d)
+{
+    n_calls[p].fetch_add(1, std::memory_order_relaxed);
+    nanoseconds[p].fetch_add(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count(),
+        std::memory_order_relaxed);
+}
+
+
+void Statistics::record_memory(Footprint k, unsigned long int bytes)
+{
+    unsigned long int peak = peak_bytes[k].load(std::memory_order_relaxed);
+    while (bytes > peak
+           && !peak_bytes[k].compare_exchange_weak(peak, bytes,
+                                                   std::memory_order_relaxed))
+        ;
+}
+
+
+bool Statistics::enabled()
+{
+#ifdef LIBCNF_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+void Statistics::reset()
+{
+    for (unsigned int s=0; s<N_SOURCES; s++)
+    {
+        n_clauses[s] = 0;
+        n_literals[s] = 0;
+    }
+    for (unsigned int l=0; l<=MAX_LENGTH; l++)
+        lengths[l] = 0;
+    for (unsigned int p=0; p<N_PHASES; p++)
+    {
+        n_calls[p] = 0;
+        nanoseconds[p] = 0;
+    }
+    for (unsigned int k=0; k<N_FOOTPRINTS; k++)
+        peak_bytes[k] = 0;
+}
+
+
+// !SECTION! Exporting
+// ===================
+
+void Statistics::to_json(std::ostream * out) const
+{
+    // The numbers are written in decimal whatever the format of the
+    // stream, which is restored at the end.
+    std::ios::fmtflags flags = out->flags(std::ios::dec | std::ios::fixed);
+    std::streamsize precision = out->precision(9);
+    (*out) << "{\n  \"enabled\": " << (enabled() ? "true" : "false")
+           << ",\n  \"sources\": {";
+    for (unsigned int s=0; s<N_SOURCES; s++)
+        (*out) << (s ? ", " : "") << "\"" << SOURCE_NAMES[s] << "\": "
+               << "{\"clauses\": " << n_clauses[s]
+               << ", \"literals\": " << n_literals[s] << "}";
+
+    // The histogram stops at the longest clause seen.
+    unsigned int longest = MAX_LENGTH + 1;
+    while (longest > 0 && lengths[longest - 1] == 0)
+        longest --;
+    (*out) << "},\n  \"clause_lengths\": [";
+    for (unsigned int l=0; l<longest; l++)
+        (*out) << (l ? ", " : "") << lengths[l];
+
+    (*out) << "],\n  \"phases\": {";
+    for (unsigned int p=0; p<N_PHASES; p++)
+        (*out) << (p ? ", " : "") << "\"" << PHASE_NAMES[p] << "\": "
+               << "{\"calls\": " << n_calls[p]
+               << ", \"seconds\": " << nanoseconds[p] * 1e-9 << "}";
+
+    (*out) << "},\n  \"peak_memory_bytes\": {";
+    for (unsigned int k=0; k<N_FOOTPRINTS; k++)
+        (*out) << (k ? ", " : "") << "\"" << FOOTPRINT_NAMES[k] << "\": "
+               << peak_bytes[k];
+    (*out) << "}\n}" << std::endl;
+    out->flags(flags);
+    out->precision(precision);
+}
@@ -6,40 +6,93 @@
  * @brief Source code of the VariableSet class
  */
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "../include/libcnf.hpp"
 
 using namespace cnf;
 
 
+// !SECTION! Subset handles
+// ========================
+
+Subset::Subset(long int first, const std::vector<unsigned int> & dim)
+{
+    first_code = first;
+    dimensions = dim;
+    strides.assign(dim.size(), 1);
+    n_variables = 1;
+    for (unsigned int i=dim.size(); i>0; i--)
+    {
+        strides[i-1] = n_variables;
+        n_variables *= dim[i-1];
+    }
+}
+
+
+CodeRange Subset::slice(std::initializer_list<unsigned int> prefix) const
+{
+    if (prefix.size() > dimensions.size())
+        throw std::domain_error(
+            "Too much coordinates for Subset.slice().");
+    unsigned int i = 0;
+    long int first = first_code;
+    for (auto c = prefix.begin(); c != prefix.end(); c++)
+    {
+        if (*c >= dimensions[i])
+        {
+            std::stringstream msg;
+            msg << "Coordinate " << i
+                << " for Subset.slice() is too large ("
+                << (*c) << " >= " << dimensions[i] << ").";
+            throw std::out_of_range(msg.str());
+        }
+        first += (*c) * strides[i];
+        i++;
+    }
+    return CodeRange(first, (i == 0) ? n_variables : strides[i-1]);
+}
+
+
 // !SECTION! Building the variable set
 // ===================================
 
 VariableSet::VariableSet()
 {
     vars_are_assigned = false;
+    n_renamed = 0;
     subset_cumulated_sizes.push_back(0);
 }
         
 
-void VariableSet::add_subset(std::string name,
-                             std::initializer_list<unsigned int > dim)
+Subset VariableSet::add_subset(const std::string & name,
+                               std::initializer_list<unsigned int > dim)
 {
-    subset_indices[name] = subset_indices.size() - 1;
-
     std::vector<unsigned int> subset_dim;
-    unsigned int
-        i = 0,
-        total_dim = 1;
+    unsigned int i = 0;
+    unsigned long int total_dim = 1;
     subset_dim.resize(dim.size());
     for (auto d = dim.begin(); d != dim.end(); d++)
     {
         subset_dim[i] = *d;
         total_dim *= subset_dim[i];
+        if (total_dim + size() > Var::MAX_CODE)
+            throw std::length_error(
+                "Too many variables: their literals must fit on 32 bits.");
         i ++;
     }
+    unsigned int index = subset_dimensions.size();
+    subset_indices[name] = index;
     subset_dimensions.push_back(subset_dim);
+    subset_handles.push_back(
+        Subset(subset_cumulated_sizes.back() + 1, subset_dim));
     subset_cumulated_sizes.push_back(
         total_dim + subset_cumulated_sizes.back());
+    LIBCNF_MEMORY(VARIABLE_SET, memory_usage());
+    return subset_handles.back();
 }
 
 
@@ -56,10 +109,19 @@ std::string VariableSet::add_subset(std::initializer_list<unsigned int > dim)
 // !SECTION! Accessing the variables' codes
 // ========================================
 
-long int VariableSet::var(std::string name,
-                          std::initializer_list<unsigned int > coord)
+unsigned int VariableSet::subset_index(const std::string & name) const
 {
-    unsigned int index = subset_indices[name];
+    auto it = subset_indices.find(name);
+    if (it == subset_indices.end())
+        throw std::domain_error("Unknown variable subset: " + name + ".");
+    return it->second;
+}
+
+
+long int VariableSet::var(const std::string & name,
+                          std::initializer_list<unsigned int > coord) const
+{
+    unsigned int index = subset_index(name);
     if (coord.size() != subset_dimensions[index].size())
         throw std::domain_error(
             "Too much coordinates for VariableSet.var().");
@@ -87,18 +149,41 @@ long int VariableSet::var(std::string name,
 }
 
 
-long int VariableSet::new_code(long int old_code)
+Subset VariableSet::subset(const std::string & name) const
 {
-    if (var_equalities[old_code] == 0)
-        return old_code;
-    else
-        return new_code(var_equalities[old_code]);
+    return subset_handles[subset_index(name)];
+}
+
+
+CodeRange VariableSet::slice(
+    const std::string & name,
+    std::initializer_list<unsigned int> prefix) const
+{
+    return subset_handles[subset_index(name)].slice(prefix);
+}
+
+
+long int VariableSet::new_code(long int old_code) const
+{
+    return new_code(Lit(old_code)).code();
+}
+
+
+Lit VariableSet::new_code(Lit old_lit) const
+{
+    uint32_t x = old_lit.var().code();
+    while (x < equalities.size() && equalities[x] != Lit())
+    {
+        old_lit = equalities[x] ^ old_lit.is_negated();
+        x = old_lit.var().code();
+    }
+    return old_lit;
 }
 
 
 long int VariableSet::new_code(
-    std::string old_name,
-    std::initializer_list<unsigned int> old_coord)
+    const std::string & old_name,
+    std::initializer_list<unsigned int> old_coord) const
 {
     return new_code(var(old_name, old_coord));
 }
@@ -106,91 +191,479 @@ long int VariableSet::new_code(
 
 void VariableSet::add_var_equality(long int x1, long int x2)
 {
-    long int
-        to_compare_1 = (x1 > 0) ? x1 : (-1)*x1,
-        to_compare_2 = (x2 > 0) ? x2 : (-1)*x2;
-    if (to_compare_1 > to_compare_2)
+    // Only the codes used for the variables are made equal so that
+    // previous equalities are kept.
+    Lit
+        l1 = new_code(Lit(x1)),
+        l2 = new_code(Lit(x2));
+    if (l1 == l2)
+        return;
+    else if (l1 == ~l2)
+        throw std::logic_error(
+            "A variable cannot be equal to its negation.");
+    // The variable with the largest code is renamed; the literal it
+    // is renamed into is stored for its positive literal.
+    if (l2.var() < l1.var())
+        std::swap(l1, l2);
+    uint32_t x = l2.var().code();
+    if (x >= equalities.size())
+        equalities.resize(x + 1);
+    equalities[x] = l1 ^ l2.is_negated();
+    n_renamed ++;
+    LIBCNF_MEMORY(VARIABLE_SET, memory_usage());
+}
+
+
+// !SECTION! Assigning the variables and using the result
+// ======================================================
+
+/** Skips the spaces and tabulations starting at p. */
+static const char * skip_blanks(const char * p, const char * end)
+{
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+        p++;
+    return p;
+}
+
+
+/** Skips everything up to the next line. */
+static const char * skip_line(const char * p, const char * end)
+{
+    while (p < end && *p != '\n')
+        p++;
+    return (p < end) ? p + 1 : p;
+}
+
+
+/** Returns true if the text starting at p begins with the given
+ * word, followed by a blank or the end of the text. */
+static bool starts_with(const char * p, const char * end, const char * word)
+{
+    while (*word != 0)
     {
-        var_equalities[x1] = x2;
-        var_equalities[no(x1)] = no(x2);
+        if (p == end || *p != *word)
+            return false;
+        p++;
+        word++;
     }
-    else
+    return p == end || *p == ' ' || *p == '\t' || *p == '\r' || *p == '\n';
+}
+
+
+/** Reads the integer starting at p, stores it in x and returns a
+ * pointer to the character following it, or NULL if there is no
+ * integer at p. */
+static const char * read_integer(const char * p, const char * end, long int & x)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        p++;
+    }
+    if (p == end || *p < '0' || *p > '9')
+        return NULL;
+    unsigned long int result = 0;
+    while (p < end && *p >= '0' && *p <= '9')
     {
-        var_equalities[x2] = x1;
-        var_equalities[no(x2)] = no(x1);
+        result = 10*result + (*p - '0');
+        p++;
     }
+    x = negative ? (-1)*(long int)result : (long int)result;
+    return p;
 }
 
-// !SECTION! Assigning the variables and using the result
-// ======================================================
 
-bool VariableSet::parse_dimacs(std::istream * input)
+/** The number of bytes of a decompressed model parsed at once. */
+static const unsigned long int MODEL_BLOCK_SIZE = 1 << 22;
+
+
+/** What is carried from a block of a model to the next one. */
+struct VariableSet::ModelParsing
 {
-    if (!(*input))
-        throw std::runtime_error("Cannot parse broken input!");
-    else
+    const DimacsNumbering & numbering;
+
+    /** The codes of the variables to assign, NULL for all. */
+    const std::vector<long int> * wanted;
+
+    /** needed[x] is true if the value of the variable with code x
+     * must be stored. */
+    std::vector<bool> needed;
+
+    /** What was found so far. */
+    bool is_sat, has_model, model_ended;
+
+    /** Is true while reading the literals of a MiniSat model, which
+     * may span any number of lines. */
+    bool minisat;
+
+    /** Is true if the output says that there is no model. */
+    bool no_model;
+
+    ModelParsing(const VariableSet * v,
+                 const DimacsNumbering & _numbering,
+                 const std::vector<long int> * _wanted)
+        : numbering(_numbering), wanted(_wanted),
+          is_sat(false), has_model(false), model_ended(false),
+          minisat(false), no_model(false)
     {
-        std::string res;
-        (*input) >> res;
-        if (res.compare("SAT") != 0)
-            return false;
-        else
+        if (wanted != NULL)
+        {
+            needed.assign(v->size() + 1, false);
+            for (unsigned int k=0; k<wanted->size(); k++)
+            {
+                long int x = v->new_code((*wanted)[k]);
+                x = (x > 0) ? x : (-1)*x;
+                if (x > 0 && (unsigned long int)x <= v->size())
+                    needed[x] = true;
+            }
+        }
+    }
+
+    /** Returns true if the rest of the output can be ignored. */
+    bool finished() const
+    {
+        return model_ended || no_model;
+    }
+};
+
+
+void VariableSet::parse_model(const char * begin,
+                              const char * end,
+                              ModelParsing & m)
+{
+    const char * p = begin;
+    while (p < end && !m.finished())
+    {
+        if (!m.minisat)
         {
-            values.assign(size(), false);
+            p = skip_blanks(p, end);
+            if (p == end)
+                break;
+            if (*p == '\n' || *p == 'c')
+            {
+                p = skip_line(p, end);
+                continue;
+            }
+            else if (starts_with(p, end, "UNSAT")
+                     || starts_with(p, end, "INDET"))
+            {
+                m.no_model = true;
+                return;
+            }
+            else if (*p == 's')
+            {
+                p = skip_blanks(p + 1, end);
+                if (!starts_with(p, end, "SATISFIABLE"))
+                {
+                    m.no_model = true;
+                    return;
+                }
+                m.is_sat = true;
+                p = skip_line(p, end);
+                continue;
+            }
+            else if (starts_with(p, end, "SAT"))
+            {
+                // MiniSat: the literals follow, on any number of lines
+                m.is_sat = true;
+                m.minisat = true;
+                p += 3;
+            }
+            else if (*p == 'v')
+                p++;
+            else
+            {
+                p = skip_line(p, end);
+                continue;
+            }
+        }
+
+        if (!m.has_model)
+        {
+            values.assign((size() + 63) / 64, 0);
+            m.has_model = true;
+        }
+        // reading literals up to the end of the line (or of the
+        // model for MiniSat, possibly in the next block)
+        while (p < end)
+        {
+            while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'
+                               || (m.minisat && *p == '\n')))
+                p++;
             long int i;
-            while ( ((*input) >> i) && (i!=0) )
+            const char * next = read_integer(p, end, i);
+            if (next == NULL)
+                break;
+            p = next;
+            if (i == 0)
             {
-                if (i>0)
-                    values[i-1] = true;
-                else
-                    values[-(i-1)] = false;
+                m.model_ended = true;
+                break;
             }
-            for (unsigned int k=1; k<=values.size(); k++)
-                if (new_code(k) > 0)
-                    values[k-1] = values[new_code(k)-1];
-                else
-                    values[k-1] = !values[(-1)*new_code(k)-1];
-
-            vars_are_assigned = true;
-            return true;
+            unsigned long int x = m.numbering.code((i > 0) ? i : (-1)*i);
+            if (x == 0 || x > size())
+                throw std::runtime_error(
+                    "Unknown variable in the DIMACS assignment.");
+            if (m.wanted == NULL || m.needed[x])
+                set_bit(x, i > 0);
+        }
+        if (p < end)
+            m.minisat = false;
+        p = skip_line(p, end);
+    }
+}
+
+
+bool VariableSet::end_model(ModelParsing & m)
+{
+    if (m.no_model || (!m.is_sat && !m.has_model))
+        return false;
+    if (!m.has_model)
+        values.assign((size() + 63) / 64, 0);
+    vars_are_assigned = true;
+    LIBCNF_MEMORY(VARIABLE_SET, memory_usage());
+    if (m.wanted == NULL)
+        propagate_equalities();
+    else
+        for (unsigned int k=0; k<m.wanted->size(); k++)
+        {
+            long int x = (*m.wanted)[k];
+            if (x > 0 && (unsigned long int)x <= size())
+                set_bit(x, literal_value(new_code(x)));
+        }
+    return true;
+}
+
+
+bool VariableSet::parse_dimacs(std::istream * input,
+                               const DimacsNumbering & numbering)
+{
+    return parse_stream(input, numbering, NULL);
+}
+
+
+bool VariableSet::parse_dimacs(std::istream * input,
+                               const std::vector<long int> & wanted,
+                               const DimacsNumbering & numbering)
+{
+    return parse_stream(input, numbering, &wanted);
+}
+
+
+bool VariableSet::parse_dimacs_file(const std::string & path,
+                                    const DimacsNumbering & numbering)
+{
+    return parse_file(path, numbering, NULL);
+}
+
+
+bool VariableSet::parse_dimacs_file(const std::string & path,
+                                    const std::vector<long int> & wanted,
+                                    const DimacsNumbering & numbering)
+{
+    return parse_file(path, numbering, &wanted);
+}
+
+
+bool VariableSet::parse_stream(std::istream * input,
+                               const DimacsNumbering & numbering,
+                               const std::vector<long int> * wanted)
+{
+    LIBCNF_TIMER(PARSE);
+    if (!(*input))
+        throw std::runtime_error("Cannot parse broken input!");
+    Compression::Input decompressed(input);
+    ModelParsing m(this, numbering, wanted);
+    const char * begin, * end;
+    while (!m.finished() && decompressed.read_lines(begin, end, MODEL_BLOCK_SIZE))
+        parse_model(begin, end, m);
+    return end_model(m);
+}
+
+
+bool VariableSet::parse_file(const std::string & path,
+                             const DimacsNumbering & numbering,
+                             const std::vector<long int> * wanted)
+{
+    LIBCNF_TIMER(PARSE);
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+        throw std::runtime_error("Cannot open " + path + ".");
+    struct stat status;
+    if (fstat(fd, &status) == -1)
+    {
+        close(fd);
+        throw std::runtime_error("Cannot read " + path + ".");
+    }
+    if (status.st_size == 0)
+    {
+        close(fd);
+        return false;
+    }
+    void * data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        throw std::runtime_error("Cannot map " + path + " in memory.");
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+    const char * begin = static_cast<const char *>(data);
+    ModelParsing m(this, numbering, wanted);
+    try
+    {
+        if (Compression::of_content(begin, begin + status.st_size)
+            == Compression::NONE)
+            parse_model(begin, begin + status.st_size, m);
+        else
+        {
+            // The model is decompressed one block after the other.
+            Compression::Input input(begin, begin + status.st_size);
+            const char * block_begin, * block_end;
+            while (!m.finished()
+                   && input.read_lines(block_begin, block_end, MODEL_BLOCK_SIZE))
+                parse_model(block_begin, block_end, m);
         }
     }
+    catch (...)
+    {
+        munmap(data, status.st_size);
+        throw;
+    }
+    munmap(data, status.st_size);
+    return end_model(m);
 }
 
 
 bool VariableSet::value(
-    std::string name,
-    std::initializer_list<unsigned int > coord)
+    const std::string & name,
+    std::initializer_list<unsigned int > coord) const
 {
     if (!vars_are_assigned)
         throw std::logic_error(
             "Cannot return value of un-assigned variable.");
     else
-        return values[var(name, coord) - 1];
+        return bit(var(name, coord));
 }
 
 
-uint32_t VariableSet::little_endian(std::initializer_list<long int> vars)
+uint32_t VariableSet::little_endian(std::initializer_list<long int> vars) const
 {
     return little_endian(std::vector<long int>(vars.begin(), vars.end()));
 }
 
 
-uint32_t VariableSet::little_endian(std::vector<long int> vars)
+uint32_t VariableSet::little_endian(std::vector<long int> vars) const
 {
+    if (!vars_are_assigned)
+        throw std::logic_error(
+            "Cannot return value of un-assigned variable.");
     uint32_t res = 0;
     for (auto b = vars.begin(); b != vars.end(); b++)
     {
         res <<= 1;
-        if (values[*b - 1])
+        if (bit(*b))
             res |= 1;
-        // else if (*b < 0 && ~values[(-1)*(*b) - 1])
-        //     res |= 1;
     }
     return res;
 }
 
 
+std::vector<uint64_t> VariableSet::extract(const CodeRange & codes) const
+{
+    if (!vars_are_assigned)
+        throw std::logic_error(
+            "Cannot return value of un-assigned variable.");
+    if (codes.size() == 0)
+        return std::vector<uint64_t>();
+    if (codes[0] < 1 || (unsigned long int)codes[codes.size()-1] > size())
+        throw std::out_of_range("Codes out of the variable set in extract().");
+
+    std::vector<uint64_t> result((codes.size() + 63) / 64);
+    unsigned long int
+        position = codes[0] - 1,
+        shift = position & 63;
+    for (unsigned long int w=0; w<result.size(); w++, position+=64)
+    {
+        unsigned long int q = position >> 6;
+        uint64_t word = values[q] >> shift;
+        if (shift != 0 && q + 1 < values.size())
+            word |= values[q+1] << (64 - shift);
+        result[w] = word;
+    }
+    if (codes.size() % 64 != 0)
+        result.back() &= (((uint64_t)1) << (codes.size() % 64)) - 1;
+    return result;
+}
+
+
+std::vector<uint64_t> VariableSet::extract(const Subset & h) const
+{
+    return extract(h.slice({}));
+}
+
+
+bool VariableSet::literal_value(long int lit) const
+{
+    if (!vars_are_assigned)
+        throw std::logic_error(
+            "Cannot return value of un-assigned variable.");
+    else if (lit == 0 || (unsigned long int)((lit > 0) ? lit : (-1)*lit) > size())
+        throw std::out_of_range("Literal out of the variable set in literal_value().");
+    else if (lit > 0)
+        return bit(lit);
+    else
+        return !bit((-1)*lit);
+}
+
+
+void VariableSet::clear_assignment()
+{
+    values.assign((size() + 63) / 64, 0);
+    vars_are_assigned = true;
+}
+
+
+void VariableSet::set_literal(long int lit)
+{
+    if (!vars_are_assigned)
+        throw std::logic_error(
+            "Cannot modify the value of un-assigned variable.");
+    else if (lit == 0 || (unsigned long int)((lit > 0) ? lit : (-1)*lit) > size())
+        throw std::out_of_range("Literal out of the variable set in set_literal().");
+    else if (lit > 0)
+        set_bit(lit, true);
+    else
+        set_bit((-1)*lit, false);
+}
+
+
+void VariableSet::propagate_equalities()
+{
+    // A variable is always renamed into one with a smaller code (see
+    // add_var_equality()) so that, going through the positive codes
+    // in increasing order, the value of the variable it is renamed
+    // into is always final.
+    for (unsigned long int x=1; x<equalities.size() && x<=size(); x++)
+        if (equalities[x] != Lit())
+        {
+            Lit target = equalities[x];
+            set_bit(x, bit(target.var().code()) != target.is_negated());
+        }
+}
+
+
+std::vector<long int> VariableSet::assignment() const
+{
+    if (!vars_are_assigned)
+        throw std::logic_error(
+            "Cannot return value of un-assigned variable.");
+    std::vector<long int> result(size());
+    for (unsigned long int x=1; x<=size(); x++)
+        result[x-1] = bit(x) ? x : (-1)*(long int)x;
+    return result;
+}
+
+
 // !SECTION! Accessing data about the variable set
 // ===============================================
 
@@ -212,19 +685,37 @@ void VariableSet::print_list_subsets()
 }
 
 
-unsigned long int VariableSet::size()
+unsigned long int VariableSet::size() const
 {
     return subset_cumulated_sizes.back();
 }
 
 
+unsigned long int VariableSet::n_equalities() const
+{
+    return n_renamed;
+}
+
+
+unsigned long int VariableSet::memory_usage() const
+{
+    unsigned long int bytes = values.capacity()*sizeof(uint64_t)
+        + equalities.capacity()*sizeof(Lit);
+    for (unsigned int i=0; i<subset_dimensions.size(); i++)
+        bytes += sizeof(Subset) + sizeof(std::vector<unsigned int>)
+            + 2*subset_dimensions[i].size()*sizeof(long int);
+    return bytes;
+}
+
+
 unsigned int VariableSet::subset_index_bound(
-    std::string name,
-    unsigned int n)
+    const std::string & name,
+    unsigned int n) const
 {
-    if (n >= subset_dimensions[subset_indices[name]].size())
+    unsigned int index = subset_index(name);
+    if (n >= subset_dimensions[index].size())
         throw std::domain_error(
             "Index of coordinate too large in VariableSet.subset_index_bound.");
-    return subset_dimensions[subset_indices[name]][n];
+    return subset_dimensions[index][n];
 }
 
@@ -8,6 +8,8 @@
 
 #include <iostream>
 #include <iomanip>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include <libcnf.hpp>
 
@@ -37,6 +39,18 @@ void test_VariableSet()
                 std::cout << v.var("z", {i}) << std::endl;
 
         std::cout << "\ntotal #variables = " << v.size() << std::endl;
+
+        std::cout << "==== handles ===" << std::endl;
+        cnf::Subset y = v.subset("y");
+        for (unsigned int i=0; i<2; i++)
+                for (unsigned int j=0; j<2; j++)
+                        for (unsigned int k=0; k<2; k++)
+                                if (v.var(y, i, j, k) != v.var("y", {i, j, k}))
+                                        std::cout << "Problem with handle" << std::endl;
+        cnf::CodeRange row = v.slice("y", {1});
+        for (unsigned int i=0; i<row.size(); i++)
+                std::cout << row[i] << " ";
+        std::cout << std::endl;
 }
 
 
@@ -66,6 +80,15 @@ void test_VariableSet_exceptions()
                           << std::endl;
         }
         try
+        {
+                v.var("w", {0});
+        }
+        catch (std::domain_error& e)
+        {
+                std::cout << "domain_error thrown correctly by var()"
+                          << std::endl;
+        }
+        try
         {
                 v.subset_index_bound("x", 2);
         }
@@ -77,6 +100,42 @@ void test_VariableSet_exceptions()
 }
 
 
+void test_VariableSet_parsing()
+{
+        std::cout << "\n---- Parsing of assignments by VariableSet ----"
+                  << std::endl;
+
+        cnf::VariableSet v;
+        v.add_subset("x", {4});
+        std::stringstream minisat("SAT\n1 -2 3 -4 0\n"),
+                competition("c comment\ns SATISFIABLE\nv -1 2\nv -3 4 0\n"),
+                unsat("s UNSATISFIABLE\n");
+        if (v.parse_dimacs(&minisat))
+                std::cout << std::hex << v.little_endian(v.slice("x", {}).codes())
+                          << std::dec << std::endl;
+        if (v.parse_dimacs(&competition))
+                std::cout << std::hex << v.little_endian(v.slice("x", {}).codes())
+                          << std::dec << std::endl;
+        std::cout << std::hex << v.extract(v.subset("x"))[0]
+                  << std::dec << std::endl;
+        if (!v.parse_dimacs(&unsat))
+                std::cout << "UNSAT correctly identified" << std::endl;
+
+        // Each export has its own numbering of the variables
+        cnf::VariableSet w;
+        cnf::Subset y = w.add_subset("y", {10});
+        cnf::Formula a(&w), b(&w);
+        a.add_clause(cnf::Clause{y(9)});
+        b.add_clause(cnf::Clause{y(3)});
+        std::stringstream dimacs_a, dimacs_b, model("SAT\n1 0\n");
+        cnf::DimacsNumbering numbering = a.to_dimacs(&dimacs_a);
+        b.to_dimacs(&dimacs_b);
+        if (w.parse_dimacs(&model, numbering))
+                std::cout << "y9=" << w.literal_value(y(9))
+                          << " y3=" << w.literal_value(y(3)) << std::endl;
+}
+
+
 void test_Clause()
 {
         std::cout << "\n---- Testing Clause ----" << std::endl;
@@ -91,6 +150,14 @@ void test_Clause()
                         std::cout << i << " *is* in the clause." << std::endl;
                 else
                         std::cout << i << " is not in the clause." << std::endl;                        
+
+        c.push_back(cnf::no(1));
+        if (!c.normalize())
+                std::cout << "tautology correctly identified" << std::endl;
+        for (unsigned int i=0; i<c.size(); i++)
+                std::cout << c[i] << " ";
+        std::cout << std::endl;
+        std::cout << "-3 is at index " << c.variable_index(-3) << std::endl;
 }
 
 
@@ -110,6 +177,93 @@ void test_Formula()
         f.add_var_equality(10, 11);
         f.add_xor(20, 21, 22);
         f.to_dimacs(&std::cout, 22);
+        std::cout << "-- with dense numbering --" << std::endl;
+        f.to_dimacs(&std::cout);
+
+        std::cout << "-- with normalization --" << std::endl;
+        cnf::Formula g(&v);
+        g.set_normalization(true);
+        g.add_clauses({
+                        cnf::Clause{3, -1, 3},
+                        cnf::Clause{-1, 3},
+                        cnf::Clause{2, -2},
+                        cnf::Clause{-4, 5, 1}
+                });
+        g.to_dimacs(&std::cout, 5);
+        cnf::NormalizationCounters counters = g.normalization_counters();
+        std::cout << counters.duplicate_literals << " duplicate literals, "
+                  << counters.tautologies << " tautologies, "
+                  << counters.duplicate_clauses << " duplicate clauses"
+                  << std::endl;
+
+        std::cout << "-- variants --" << std::endl;
+        f.freeze();
+        cnf::Formula f1 = f.variant(), f2 = f.variant();
+        f1.add_clause(cnf::Clause{4});
+        f2.add_clause(cnf::Clause{-5});
+        f2.freeze();
+        cnf::Formula f3 = f2.variant();
+        f3.add_clause(cnf::Clause{2, 3});
+        std::cout << f.size() << " " << f1.size() << " " << f2.size() << " "
+                  << f3.size() << " " << f3.n_frozen_clauses() << std::endl;
+        f3.to_dimacs(&std::cout, 22);
+
+        std::cout << "-- incremental export --" << std::endl;
+        f3.to_dimacs_file("/tmp/libcnf_test.cnf");
+        f3.add_clause(cnf::Clause{-20, 30});
+        f3.to_dimacs_file("/tmp/libcnf_test.cnf");
+        std::cout << f3.last_export_reused() << " clauses kept" << std::endl;
+        std::ifstream in("/tmp/libcnf_test.cnf");
+        std::cout << in.rdbuf();
+
+        // Another file of the same size with the same modification
+        // time is not taken for the previous export.
+        cnf::Formula reversed(&v);
+        for (unsigned long int i=f3.size(); i>0; i--)
+                reversed.add_clause(f3.clause(i - 1));
+        struct stat before;
+        stat("/tmp/libcnf_test.cnf", &before);
+        reversed.to_dimacs_file("/tmp/libcnf_test.cnf");
+        struct timespec times[2] = {before.st_atim, before.st_mtim};
+        utimensat(AT_FDCWD, "/tmp/libcnf_test.cnf", times, 0);
+        f3.add_clause(cnf::Clause{-30});
+        f3.to_dimacs_file("/tmp/libcnf_test.cnf");
+        std::cout << f3.last_export_reused() << " clauses kept" << std::endl;
+
+        std::cout << "-- streaming --" << std::endl;
+        cnf::Formula h(&v);
+        h.add_clause(cnf::Clause{1, -2});
+        h.stream_to(&std::cout);
+        h.add_clause(cnf::Clause{-3, 4});
+        h.add_xor(20, 21, 22);
+        std::cout << h.n_streamed_clauses() << " clauses written, "
+                  << h.size() << " stored" << std::endl;
+        std::cout << h.end_stream() << " clauses written" << std::endl;
+
+        // The header is patched once all the clauses are written.
+        const char * stream_paths[] = {"/tmp/libcnf_stream.cnf",
+                                       "/tmp/libcnf_stream.cnf.gz"};
+        for (const char * path : stream_paths)
+        {
+                if (!cnf::Compression::available(cnf::Compression::of_path(path)))
+                        continue;
+                cnf::Formula s(&v);
+                s.stream_to(path);
+                s.add_clause(cnf::Clause{1, -2});
+                s.add_var_equality(2, 30);
+                s.add_xor(20, 21, 22);
+                unsigned long int n_written = s.end_stream();
+                cnf::Formula t(&v);
+                cnf::DimacsReader r;
+                r.read_file(path, &t);
+                std::cout << path << ": " << n_written << " clauses written, "
+                          << r.clauses_read() << " read, "
+                          << r.variables_read() << " variables" << std::endl;
+        }
+        std::ifstream streamed("/tmp/libcnf_stream.cnf");
+        std::string header;
+        std::getline(streamed, header);
+        std::cout << header << std::endl;
 }
 
 
@@ -171,7 +325,7 @@ void test_Sbox()
                 {
                         std::cout << std::hex << x << " "
                                   << v.little_endian(output)
-                                  << std::endl;
+                                  << std::dec << std::endl;
                 }
                 else
                         std::cout << "Problem with Sbox" << std::endl;
@@ -180,14 +334,575 @@ void test_Sbox()
 }
 
 
+void test_Preprocessor()
+{
+        std::cout << "\n---- Testing Preprocessor ----" << std::endl;
+
+        cnf::VariableSet v;
+        v.add_subset("x", {6});
+        cnf::Formula f(&v);
+        f.assign_to_integer({v.var("x", {0})}, 1);
+        f.add_clauses({
+                cnf::Clause{cnf::no(v.var("x", {0})), v.var("x", {1})},
+                cnf::Clause{v.var("x", {2}), v.var("x", {3})},
+                cnf::Clause{v.var("x", {2}), v.var("x", {3}), v.var("x", {4})},
+                cnf::Clause{v.var("x", {3}), v.var("x", {2})},
+                cnf::Clause{v.var("x", {4}), cnf::no(v.var("x", {4}))},
+                cnf::Clause{cnf::no(v.var("x", {2})), v.var("x", {5})},
+                cnf::Clause{cnf::no(v.var("x", {5})), v.var("x", {3})}
+                });
+        cnf::Preprocessor p;
+        p.freeze(v.var("x", {2}));
+        if (p.run(&f))
+                f.to_dimacs(&std::cout, v.size());
+        else
+                std::cout << "Problem with Preprocessor" << std::endl;
+        p.print_statistics();
+
+        // x0 = x1 = no(x2) is implied by the binary clauses
+        cnf::VariableSet w;
+        w.add_subset("x", {4});
+        cnf::Formula g(&w);
+        g.add_var_equality_clauses(w.var("x", {0}), w.var("x", {1}));
+        g.add_clauses({
+                cnf::Clause{w.var("x", {1}), w.var("x", {2})},
+                cnf::Clause{cnf::no(w.var("x", {2})), cnf::no(w.var("x", {0}))},
+                cnf::Clause{w.var("x", {2}), w.var("x", {3}), w.var("x", {1})}
+                });
+        cnf::Preprocessor q;
+        q.set_pass(cnf::Preprocessor::ELIMINATION, false);
+        q.run(&g);
+        g.to_dimacs(&std::cout, w.size());
+        std::cout << "x2 is still " << w.new_code("x", {2}) << std::endl;
+        q.print_statistics();
+
+        // Merging y0 and y1 in h must not affect k
+        cnf::VariableSet u;
+        cnf::Subset y = u.add_subset("y", {2});
+        cnf::Formula h(&u), k(&u);
+        h.add_var_equality_clauses(y(0), y(1));
+        k.add_clauses({cnf::Clause{y(0)}, cnf::Clause{cnf::no(y(1))}});
+        cnf::Preprocessor().run(&h);
+        cnf::IncrementalSolver s(&u);
+        s.add_formula(k);
+        std::cout << "k is " << (s.solve() ? "SAT" : "UNSAT") << std::endl;
+        cnf::IncrementalSolver t(&u);
+        t.add_formula(h);
+        t.solve({y(0)});
+        t.store_model();
+        h.extend_model();
+        std::cout << "y1 = " << u.literal_value(y(1)) << std::endl;
+}
+
+
+void test_Enumerator()
+{
+        std::cout << "\n---- Testing Enumerator ----" << std::endl;
+
+        // x0 or x1, x2 being free: 3 solutions on {x0, x1}, 6 on all
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {3});
+        cnf::Formula f(&v);
+        f.add_clause(cnf::Clause{x(0), x(1)});
+
+        cnf::IncrementalSolver s(&v);
+        s.add_formula(f);
+        if (!s.solve({cnf::no(x(0)), cnf::no(x(1))}))
+        {
+                std::cout << "Failed assumptions:";
+                std::vector<long int> core = s.failed_assumptions();
+                for (unsigned int i=0; i<core.size(); i++)
+                        std::cout << " " << core[i];
+                std::cout << std::endl;
+        }
+        else
+                std::cout << "Problem with IncrementalSolver" << std::endl;
+
+        cnf::Enumerator e(&f);
+        e.set_projection(x.slice({}).codes());
+        std::cout << e.run([&](cnf::VariableSet * w) {
+                        std::cout << w->extract(x)[0] << " ";
+                        return true;
+                }) << " solutions" << std::endl;
+
+        cnf::Enumerator g(&f);
+        g.set_projection({x(0), x(1)});
+        g.set_minimal_blocking(true);
+        std::cout << g.run([](cnf::VariableSet *) {return true;})
+                  << " projected solutions" << std::endl;
+}
+
+
+void test_Backbone()
+{
+        std::cout << "\n---- Testing Backbone ----" << std::endl;
+
+        // k0 = k1 xor k2 and k1 = 1 force k1 but neither k0 nor k2
+        // alone; k3 = 0 is forced as well.
+        cnf::VariableSet v;
+        cnf::Subset k = v.add_subset("k", {4});
+        cnf::Formula f(&v);
+        f.add_xor(k(0), k(1), k(2));
+        f.add_clauses({cnf::Clause{k(1)}, cnf::Clause{cnf::no(k(3)), k(1)},
+                       cnf::Clause{cnf::no(k(3)), cnf::no(k(1))}});
+        cnf::Backbone b(&f);
+        if (b.run(k.slice({}).codes()))
+        {
+                std::vector<long int>
+                        forced = b.forced_literals(),
+                        free = b.free_codes();
+                std::cout << "Forced:";
+                for (unsigned int i=0; i<forced.size(); i++)
+                        std::cout << " " << forced[i];
+                std::cout << std::endl << "Free:";
+                for (unsigned int i=0; i<free.size(); i++)
+                        std::cout << " " << free[i];
+                std::cout << std::endl << b.solver_calls()
+                          << " calls to the solver" << std::endl;
+        }
+        else
+                std::cout << "Problem with Backbone" << std::endl;
+}
+
+
+void test_CubeAndConquer()
+{
+        std::cout << "\n---- Testing CubeAndConquer ----" << std::endl;
+
+        // y = S(x) with S the PRESENT S-box and y = 0xc: x must be 0.
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {4}), y = v.add_subset("y", {4});
+        cnf::Formula f(&v);
+        cnf::Sbox s(4, 4, {0xc, 0x5, 0x6, 0xb, 0x9, 0x0, 0xa, 0xd,
+                           0x3, 0xe, 0xf, 0x8, 0x4, 0x7, 0x1, 0x2});
+        s.add_clauses_image(&f, x.slice({}).codes(), y.slice({}).codes());
+        f.assign_to_integer(y.slice({}).codes(), 0xc);
+        cnf::CubeAndConquer c(&f);
+        c.set_threads(2);
+        c.set_split_variables({x(0), x(1)});
+        if (c.run())
+                std::cout << "x = " << v.extract(x)[0] << std::endl;
+        else
+                std::cout << "Problem with CubeAndConquer" << std::endl;
+        c.print_statistics();
+}
+
+
+void test_Decomposition()
+{
+        std::cout << "\n---- Testing Decomposition ----" << std::endl;
+
+        // Two independent queries of the same S-box.
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {2, 4}), y = v.add_subset("y", {2, 4});
+        cnf::Formula f(&v);
+        cnf::Sbox s(4, 4, {0xc, 0x5, 0x6, 0xb, 0x9, 0x0, 0xa, 0xd,
+                           0x3, 0xe, 0xf, 0x8, 0x4, 0x7, 0x1, 0x2});
+        for (unsigned int i=0; i<2; i++)
+        {
+                s.add_clauses_image(&f, x.slice({i}).codes(), y.slice({i}).codes());
+                f.assign_to_integer(y.slice({i}).codes(), 0x5+i);
+        }
+        cnf::Decomposition d(&f);
+        std::cout << d.size() << " components" << std::endl;
+        if (d.solve())
+                std::cout << "x0 = " << v.little_endian(x.slice({0}).codes())
+                          << ", x1 = " << v.little_endian(x.slice({1}).codes())
+                          << std::endl;
+        else
+                std::cout << "Problem with Decomposition" << std::endl;
+}
+
+
+void test_LocalSearch()
+{
+        std::cout << "\n---- Testing LocalSearch ----" << std::endl;
+
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {4}), y = v.add_subset("y", {4});
+        cnf::Formula f(&v);
+        cnf::Sbox s(4, 4, {0xc, 0x5, 0x6, 0xb, 0x9, 0x0, 0xa, 0xd,
+                           0x3, 0xe, 0xf, 0x8, 0x4, 0x7, 0x1, 0x2});
+        s.add_clauses_image(&f, x.slice({}).codes(), y.slice({}).codes());
+        f.assign_to_integer(y.slice({}).codes(), 0x9);
+        cnf::LocalSearch ls(&f);
+        ls.set_threads(2);
+        if (ls.run())
+                std::cout << "x = " << v.little_endian(x.slice({}).codes())
+                          << std::endl;
+        else
+                std::cout << "Problem with LocalSearch" << std::endl;
+
+        // Warm start of the next solve from the previous model: as
+        // it satisfies the formula, following the hints gives it back.
+        std::vector<long int> previous = v.assignment();
+        cnf::IncrementalSolver solver(&v);
+        solver.add_formula(f);
+        solver.set_phases(previous);
+        if (solver.solve())
+        {
+                solver.store_model();
+                std::cout << "same model: " << (v.assignment() == previous)
+                          << std::endl;
+        }
+        else
+                std::cout << "Problem with IncrementalSolver" << std::endl;
+
+        // The hints may set the free variables of g to anything.
+        cnf::Formula g(&v);
+        g.add_clause(cnf::Clause{x(0), x(1), x(2), x(3)});
+        std::vector<long int> hints{cnf::no(x(0)), x(1), cnf::no(x(2)), x(3)};
+        cnf::IncrementalSolver hinted(&v);
+        hinted.add_formula(g);
+        hinted.set_phases(hints);
+        if (hinted.solve())
+        {
+                hinted.store_model();
+                std::cout << "x = " << v.little_endian(x.slice({}).codes())
+                          << std::endl;
+        }
+        cnf::LocalSearch warm(&g);
+        warm.set_phases(hints);
+        if (warm.run())
+                std::cout << "x = " << v.little_endian(x.slice({}).codes())
+                          << std::endl;
+}
+
+
+void test_ResultCache()
+{
+        std::cout << "\n---- Testing ResultCache ----" << std::endl;
+
+        // The same clauses in another order give the same key.
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {3});
+        cnf::Formula f(&v), g(&v);
+        f.add_clauses({cnf::Clause{x(0), x(1)}, cnf::Clause{cnf::no(x(2))}});
+        g.add_clauses({cnf::Clause{cnf::no(x(2))}, cnf::Clause{x(1), x(0)}});
+        cnf::ResultCache cache;
+        cnf::ResultCache::Key k = cnf::ResultCache::hash(f);
+        std::cout << (k == cnf::ResultCache::hash(g)) << " "
+                  << (k == cnf::ResultCache::hash(f, {x(0)})) << std::endl;
+
+        cnf::IncrementalSolver s(&v);
+        s.add_formula(f);
+        if (s.solve())
+        {
+                s.store_model();
+                cache.store_satisfiable(k, v);
+        }
+        if (cache.lookup(cnf::ResultCache::hash(g), &v)
+            == cnf::ResultCache::SATISFIABLE)
+                std::cout << "x = " << v.extract(x)[0] << std::endl;
+        else
+                std::cout << "Problem with ResultCache" << std::endl;
+        cache.print_statistics();
+
+        // f1 and f2 are both preprocessed into the empty formula: the
+        // model found for f1 must be extended into one of f2.
+        cnf::Formula f1(&v), f2(&v);
+        f1.add_clauses({cnf::Clause{x(0)}, cnf::Clause{x(1), x(2)}});
+        f2.add_clauses({cnf::Clause{cnf::no(x(0))}, cnf::Clause{x(1), x(2)}});
+        cnf::Preprocessor().run(&f1);
+        cnf::Preprocessor().run(&f2);
+        std::cout << (cnf::ResultCache::hash(f1) == cnf::ResultCache::hash(f2))
+                  << std::endl;
+        cnf::Solver solver("minisat", {});
+        solver.set_cache(&cache);
+        if (solver.solve(&f1, &v))
+                std::cout << "x0 = " << v.literal_value(x(0)) << std::endl;
+        if (solver.solve(&f2, &v))
+                std::cout << "x0 = " << v.literal_value(x(0))
+                          << ", x1 or x2 = "
+                          << (v.literal_value(x(1)) || v.literal_value(x(2)))
+                          << std::endl;
+        cache.print_statistics();
+
+        // A failed run of the SAT-solver is not cached.
+        cnf::Formula h(&v);
+        h.add_clauses({cnf::Clause{x(0)}, cnf::Clause{cnf::no(x(1))}});
+        cnf::Solver missing("libcnf-missing-solver", {});
+        missing.set_cache(&cache);
+        try
+        {
+                missing.solve(&h, &v);
+        }
+        catch (std::runtime_error & e)
+        {
+                std::cout << "missing solver detected, "
+                          << cache.size() << " queries stored" << std::endl;
+        }
+
+        // A record cut by a crash is dropped when the file is opened.
+        std::remove("/tmp/libcnf_test.cache");
+        {
+                cnf::ResultCache file_cache("/tmp/libcnf_test.cache");
+                file_cache.store_satisfiable(k, v);
+                file_cache.store_unsatisfiable(cnf::ResultCache::hash(f, {x(2)}),
+                                               {x(2)});
+        }
+        {
+                std::ofstream torn("/tmp/libcnf_test.cache",
+                                   std::ios::binary | std::ios::app);
+                torn.write("\x30\x00\x00\x00garbage", 11);
+        }
+        cnf::ResultCache reopened("/tmp/libcnf_test.cache");
+        reopened.store_unsatisfiable(cnf::ResultCache::hash(h));
+        cnf::ResultCache again("/tmp/libcnf_test.cache");
+        std::cout << reopened.size() << " " << again.size() << std::endl;
+}
+
+
+void test_Snapshot()
+{
+        std::cout << "\n---- Testing Snapshot ----" << std::endl;
+
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {2, 3});
+        cnf::Formula f(&v);
+        f.add_xor(x(0, 0), x(0, 1), x(0, 2));
+        f.add_clause(cnf::Clause{x(1, 0), cnf::no(x(1, 2))});
+        f.add_var_equality(x(1, 1), cnf::no(x(0, 0)));
+        cnf::Snapshot::save(f, "/tmp/libcnf_test.snap");
+
+        // The loaded formula is exported exactly like the original
+        // one and can be extended.
+        cnf::VariableSet w;
+        cnf::Formula g(&w);
+        cnf::Snapshot::load("/tmp/libcnf_test.snap", &g);
+        std::stringstream a, b;
+        f.to_dimacs(&a);
+        g.to_dimacs(&b);
+        std::cout << (a.str() == b.str()) << " "
+                  << w.var("x", {1, 2}) << " "
+                  << w.new_code(x(1, 1)) << std::endl;
+        g.add_clause(cnf::Clause{w.var("x", {0, 0})});
+        std::cout << g.size() << " " << g.clause(g.size() - 2).size() << std::endl;
+}
+
+
+void test_FormulaTemplate()
+{
+        std::cout << "\n---- Testing FormulaTemplate ----" << std::endl;
+
+        // A toy cipher: x[r+1] = S(x[r] xor k[r]), with y[r] = x[r]
+        // xor k[r].
+        cnf::Sbox sbox(4, 4, {  0x5, 0xb, 0x6, 0xe, 0x8, 0x2, 0x7, 0xa,
+                                0x3, 0x4, 0x0, 0xc, 0x1, 0x9, 0xf, 0xd});
+        cnf::VariableSet v;
+        cnf::Subset
+                x = v.add_subset("x", {4, 4}),
+                k = v.add_subset("k", {3, 4}),
+                y = v.add_subset("y", {3, 4});
+        cnf::Formula generated(&v), instantiated(&v), round(&v);
+        for (unsigned int r=0; r<3; r++)
+                for (unsigned int i=0; i<4; i++)
+                        generated.add_xor(x(r, i), k(r, i), cnf::no(y(r, i)));
+        for (unsigned int r=0; r<3; r++)
+                sbox.add_clauses_image(&generated,
+                                       y.slice({r}).codes(),
+                                       x.slice({r+1}).codes());
+
+        for (unsigned int i=0; i<4; i++)
+                round.add_xor(x(0, i), k(0, i), cnf::no(y(0, i)));
+        cnf::FormulaTemplate xor_key(round, {x.slice({0}), k.slice({0}), y.slice({0})});
+        cnf::Formula s_layer(&v);
+        sbox.add_clauses_image(&s_layer, y.slice({0}).codes(), x.slice({1}).codes());
+        cnf::FormulaTemplate sub(s_layer, {y.slice({0}), x.slice({1})});
+        for (unsigned int r=0; r<3; r++)
+                xor_key.instantiate(&instantiated, {x.slice({r}), k.slice({r}), y.slice({r})});
+        for (unsigned int r=0; r<3; r++)
+                sub.instantiate(&instantiated, {y.slice({r}), x.slice({r+1})});
+
+        std::stringstream a, b;
+        generated.to_dimacs(&a, v.size());
+        instantiated.to_dimacs(&b, v.size());
+        std::cout << sub.size() << " " << sub.n_slots() << " "
+                  << instantiated.size() << " "
+                  << (a.str() == b.str()) << std::endl;
+}
+
+
+void test_FormulaBuilder()
+{
+        std::cout << "\n---- Testing FormulaBuilder ----" << std::endl;
+
+        cnf::Sbox sbox(4, 4, {  0x5, 0xb, 0x6, 0xe, 0x8, 0x2, 0x7, 0xa,
+                                0x3, 0x4, 0x0, 0xc, 0x1, 0x9, 0xf, 0xd});
+        cnf::VariableSet v, w;
+        cnf::Subset x = v.add_subset("x", {9, 4});
+        cnf::Formula sequential(&v), parallel(&w);
+        for (unsigned int r=0; r<8; r++)
+        {
+                sbox.add_clauses_image(&sequential,
+                                       x.slice({r}).codes(),
+                                       x.slice({r+1}).codes());
+                sequential.add_var_equality(x(r, 0), cnf::no(x(r+1, 3)));
+        }
+
+        cnf::FormulaBuilder b(&parallel);
+        b.set_threads(4);
+        cnf::Subset y = b.add_subset("x", {9, 4});
+        b.run(8, [&](cnf::Formula * shard, unsigned long int r) {
+                        sbox.add_clauses_image(shard,
+                                               y.slice({(unsigned int)r}).codes(),
+                                               y.slice({(unsigned int)r+1}).codes());
+                        shard->add_var_equality(y(r, 0), cnf::no(y(r+1, 3)));
+                });
+        std::stringstream a, c;
+        sequential.to_dimacs(&a);
+        parallel.to_dimacs(&c);
+        std::cout << parallel.size() << " " << b.n_shards() << " "
+                  << (a.str() == c.str()) << std::endl;
+}
+
+
+void test_Statistics()
+{
+        std::cout << "\n---- Testing Statistics ----" << std::endl;
+
+        // Only meaningful if libcnf was compiled with LIBCNF_STATS.
+        cnf::Statistics::global().reset();
+        cnf::Sbox sbox(4, 4, {  0x5, 0xb, 0x6, 0xe, 0x8, 0x2, 0x7, 0xa,
+                                0x3, 0x4, 0x0, 0xc, 0x1, 0x9, 0xf, 0xd});
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {3, 4});
+        cnf::Formula f(&v);
+        sbox.add_clauses_image(&f, x.slice({0}).codes(), x.slice({1}).codes());
+        f.add_xor(x(2, 0), x(2, 1), x(2, 2));
+        f.add_clause(cnf::Clause{x(2, 3)});
+        std::stringstream dimacs;
+        f.to_dimacs(&dimacs);
+        // The numbers are written in decimal whatever the format of
+        // the stream, which is then restored.
+        std::cout << std::hex;
+        cnf::Statistics::global().to_json(&std::cout);
+        std::cout << 255 << std::dec << std::endl;
+}
+
+
+void test_DimacsReader()
+{
+        std::cout << "\n---- Testing DimacsReader ----" << std::endl;
+
+        std::stringstream input;
+        input << "c A small instance.\n"
+              << "p cnf 4 3\n"
+              << "1 -2 0\n"
+              << "2 3\n"
+              << "  -4 0 -1 0\n"
+              << "x1 2 -3 0\n";
+        cnf::VariableSet v;
+        cnf::Formula f(&v);
+        cnf::DimacsReader r;
+        r.read_stream(&input, &f);
+        std::cout << r.clauses_read() << " clauses, "
+                  << r.xors_read() << " xor, "
+                  << r.variables_read() << " variables" << std::endl;
+        f.to_dimacs(&std::cout, v.size());
+}
+
+
+void test_Lit()
+{
+        std::cout << "\n---- Testing Lit ----" << std::endl;
+
+        cnf::Lit a(5), b(-5);
+        std::cout << a.index() << " " << b.index() << " "
+                  << (~a == b) << " " << (a.var() == b.var()) << " "
+                  << b.code() << " " << (a ^ true).code() << std::endl;
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {10});
+        v.add_var_equality(x(7), cnf::no(x(2)));
+        std::cout << v.new_code(cnf::Lit(x(7))).code() << " "
+                  << v.new_code(cnf::Lit(cnf::no(x(7)))).code() << std::endl;
+}
+
+
+void test_Compression()
+{
+        std::cout << "\n---- Testing Compression ----" << std::endl;
+
+        cnf::VariableSet v;
+        cnf::Subset x = v.add_subset("x", {4});
+        cnf::Formula f(&v);
+        f.add_clauses({
+                cnf::Clause{x(0), cnf::no(x(1))},
+                cnf::Clause{x(1), x(2), cnf::no(x(3))}
+                });
+        cnf::Compression::Codec codecs[] = {cnf::Compression::GZIP,
+                                            cnf::Compression::XZ,
+                                            cnf::Compression::ZSTD};
+        for (cnf::Compression::Codec codec : codecs)
+        {
+                std::string path = "/tmp/libcnf_test.cnf"
+                        + cnf::Compression::extension(codec);
+                if (!cnf::Compression::available(codec))
+                {
+                        std::cout << path << ": not available" << std::endl;
+                        continue;
+                }
+                f.to_dimacs_file(path);
+                cnf::Formula g(&v);
+                cnf::DimacsReader r;
+                r.read_file(path, &g);
+                std::cout << path << ": " << g.size() << " clauses read"
+                          << std::endl;
+        }
+
+        // Decompression by blocks of whole lines.
+        if (cnf::Compression::available(cnf::Compression::GZIP))
+        {
+                cnf::Compression::Output out("/tmp/libcnf_test.cnf.gz",
+                                             cnf::Compression::GZIP);
+                for (unsigned int i=0; i<100; i++)
+                        out << "1 -2 0\n";
+                out << "2 3 -4";
+                out.close();
+                std::ifstream file("/tmp/libcnf_test.cnf.gz", std::ios::binary);
+                cnf::Compression::Input in(&file);
+                const char * begin, * end;
+                unsigned int n_blocks = 0, n_lines = 0;
+                while (in.read_lines(begin, end, 16))
+                {
+                        n_blocks ++;
+                        n_lines += std::count(begin, end, '\n');
+                }
+                std::cout << n_blocks << " blocks, " << n_lines
+                          << " lines" << std::endl;
+                std::ifstream again("/tmp/libcnf_test.cnf.gz", std::ios::binary);
+                cnf::Formula g(&v);
+                cnf::DimacsReader r;
+                r.read_stream(&again, &g);
+                std::cout << r.clauses_read() << " clauses read from the stream"
+                          << std::endl;
+        }
+}
+
+
 int main(int argc, char *argv[])
 {
         test_VariableSet();
         test_VariableSet_exceptions();
+        test_VariableSet_parsing();
         test_Clause();
         test_Formula();
         test_Solver();
         test_Sbox();
+        test_Preprocessor();
+        test_Enumerator();
+        test_Backbone();
+        test_CubeAndConquer();
+        test_Decomposition();
+        test_LocalSearch();
+        test_ResultCache();
+        test_Snapshot();
+        test_FormulaTemplate();
+        test_FormulaBuilder();
+        test_Statistics();
+        test_DimacsReader();
+        test_Lit();
+        test_Compression();
         
         std::cout << std::endl;
         return 0;